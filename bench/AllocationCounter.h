@@ -0,0 +1,45 @@
+#pragma once
+#include <NovusTypes.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/*
+    Replaces the global operator new and delete to count heap allocations and the bytes they hold.
+    Every allocation carries its size in a header in front of it, include this from the one translation unit of a bench.
+*/
+namespace AllocationCounter
+{
+    constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+    inline std::atomic<u64> numAllocations { 0 };
+    inline std::atomic<i64> liveBytes { 0 };
+
+    inline u64 GetNumAllocations() { return numAllocations.load(std::memory_order_relaxed); }
+    inline i64 GetLiveBytes() { return liveBytes.load(std::memory_order_relaxed); }
+}
+
+void* operator new(size_t size)
+{
+    u8* block = static_cast<u8*>(std::malloc(size + AllocationCounter::HEADER_SIZE));
+    if (!block)
+        throw std::bad_alloc();
+
+    *reinterpret_cast<size_t*>(block) = size;
+    AllocationCounter::numAllocations.fetch_add(1, std::memory_order_relaxed);
+    AllocationCounter::liveBytes.fetch_add(static_cast<i64>(size), std::memory_order_relaxed);
+    return block + AllocationCounter::HEADER_SIZE;
+}
+void operator delete(void* pointer) noexcept
+{
+    if (!pointer)
+        return;
+
+    u8* block = static_cast<u8*>(pointer) - AllocationCounter::HEADER_SIZE;
+    AllocationCounter::liveBytes.fetch_sub(static_cast<i64>(*reinterpret_cast<size_t*>(block)), std::memory_order_relaxed);
+    std::free(block);
+}
+void operator delete(void* pointer, size_t) noexcept
+{
+    operator delete(pointer);
+}
@@ -0,0 +1,137 @@
+#include <NovusTypes.h>
+#include <Networking/NetPacket.h>
+#include <Utils/ByteBuffer.h>
+#include <Network/PacketLanes.h>
+#include <Utils/SPSCRingBuffer.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include "AllocationCounter.h"
+
+/*
+    Frames packets into the lanes and dispatches them back out the way ConnectionUpdateSystem does, one batch at a time.
+    Compares the slot-owned lanes against the shared_ptr packets they replaced, which borrowed a NetPacket and an 8 KiB payload for every packet.
+    Reports nanoseconds and heap allocations per packet.
+*/
+
+constexpr size_t NUM_PACKETS = 2000000;
+constexpr size_t BATCH_SIZE = 512;
+
+// Address requests are small, bulk requests and topology updates are not
+constexpr u16 PAYLOAD_SIZES[] = { 9, 9, 9, 20, 9, 9, 9, 1200 };
+constexpr size_t NUM_PAYLOAD_SIZES = sizeof(PAYLOAD_SIZES) / sizeof(PAYLOAD_SIZES[0]);
+
+struct Result
+{
+    f64 nsPerPacket = 0.0;
+    f64 allocationsPerPacket = 0.0;
+    u64 checksum = 0;
+};
+
+// Stands in for a handler, it reads the payload through the same shared_ptr interface handlers get
+static u64 Handle(const std::shared_ptr<NetPacket>& packet)
+{
+    u8 value = 0;
+    if (packet->payload)
+        packet->payload->GetU8(value);
+
+    return static_cast<u64>(packet->header.size) + value;
+}
+
+template <typename Func>
+static Result Run(Func&& func)
+{
+    // The first pass grows whatever the lanes hold on to, only the second one is measured
+    func();
+
+    u64 allocationsBefore = AllocationCounter::GetNumAllocations();
+    auto start = std::chrono::steady_clock::now();
+
+    Result result;
+    result.checksum = func();
+
+    f64 elapsed = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - start).count();
+    result.nsPerPacket = elapsed / NUM_PACKETS;
+    result.allocationsPerPacket = static_cast<f64>(AllocationCounter::GetNumAllocations() - allocationsBefore) / NUM_PACKETS;
+    return result;
+}
+
+int main()
+{
+    static u8 stream[2048];
+    for (size_t i = 0; i < sizeof(stream); i++)
+        stream[i] = static_cast<u8>(i * 31);
+
+    static SPSCRingBuffer<std::shared_ptr<NetPacket>, 1024> sharedQueue;
+    Result shared = Run([]()
+    {
+        u64 checksum = 0;
+        for (size_t sent = 0; sent < NUM_PACKETS; sent += BATCH_SIZE)
+        {
+            for (size_t i = 0; i < BATCH_SIZE; i++)
+            {
+                u16 size = PAYLOAD_SIZES[(sent + i) % NUM_PAYLOAD_SIZES];
+
+                std::shared_ptr<NetPacket> packet = NetPacket::Borrow();
+                packet->header.opcode = Opcode::MSG_REQUEST_ADDRESS;
+                packet->header.size = size;
+                packet->payload = Bytebuffer::Borrow<8192>();
+                packet->payload->size = size;
+                packet->payload->writtenData = size;
+                std::memcpy(packet->payload->GetDataPointer(), stream, size);
+
+                sharedQueue.TryEnqueue(std::move(packet));
+            }
+
+            std::shared_ptr<NetPacket> packet = nullptr;
+            while (sharedQueue.TryDequeue(packet))
+            {
+                checksum += Handle(packet);
+                packet = nullptr;
+            }
+        }
+
+        return checksum;
+    });
+
+    static PacketLanes packetLanes;
+    Result slots = Run([]()
+    {
+        u64 checksum = 0;
+        for (size_t sent = 0; sent < NUM_PACKETS; sent += BATCH_SIZE)
+        {
+            for (size_t i = 0; i < BATCH_SIZE; i++)
+            {
+                u16 size = PAYLOAD_SIZES[(sent + i) % NUM_PAYLOAD_SIZES];
+
+                NetPacket* packet = packetLanes.TryReserve(PacketLane::DATA, size);
+                packet->header.opcode = Opcode::MSG_REQUEST_ADDRESS;
+                packet->header.size = size;
+                std::memcpy(packet->payload->GetDataPointer(), stream, size);
+
+                packetLanes.Commit(PacketLane::DATA);
+            }
+
+            PacketLane lane = PacketLane::CONTROL;
+            while (NetPacket* packet = packetLanes.Front(lane))
+            {
+                checksum += Handle(PacketLanes::MakeHandle(packet));
+                packetLanes.Pop(lane);
+            }
+        }
+
+        return checksum;
+    });
+
+    if (shared.checksum != slots.checksum)
+    {
+        std::printf("Checksum mismatch, shared_ptr %llu, slots %llu\n", static_cast<unsigned long long>(shared.checksum), static_cast<unsigned long long>(slots.checksum));
+        return 1;
+    }
+
+    std::printf("%zu packets in batches of %zu\n", NUM_PACKETS, BATCH_SIZE);
+    std::printf("%-12s %10s %14s\n", "lanes", "ns/packet", "allocs/packet");
+    std::printf("%-12s %10.1f %14.2f\n", "shared_ptr", shared.nsPerPacket, shared.allocationsPerPacket);
+    std::printf("%-12s %10.1f %14.2f\n", "slots", slots.nsPerPacket, slots.allocationsPerPacket);
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include <NovusTypes.h>
+#include <entity/registry.hpp>
+#include <ECS/Components/Network/LoadBalanceSingleton.h>
+#include <ECS/Components/Network/PlacementSingleton.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "AllocationCounter.h"
+
+/*
+    Fills a pool with NUM_BACKENDS world servers and times round robin selection over it through LoadBalanceSingleton::Select, the path address requests take.
+    Selection is timed with every server selectable and with most of them draining, which makes every selection scan past the drained ones.
+    Bytes per entry is the heap the pool and the backend entities hold per server, the pool's arrays are also broken out on their own.
+
+    The layout comparison copies pools of growing size into an array of structs, one AoSServer per server, and runs the same two scans over both layouts:
+    the selection scan walks from a cursor to the next server that is not excluded, the fit scan is PlacementSingleton::FindFit's two pass reduction over GetFitKey.
+    Place then Release through PlacementSingleton is timed alongside as the fit scan the handlers actually run.
+*/
+
+constexpr u32 NUM_BACKENDS = 10000;
+constexpr u32 NUM_SELECTIONS = 2000000;
+constexpr u32 DRAINED_OUT_OF_TEN = 9;
+
+constexpr u32 LAYOUT_POOL_SIZES[] = { 1000, 10000, 100000 };
+constexpr u64 LAYOUT_SERVERS_PER_RUN = 50000000; // Servers visited per timed fit scan run, the number of scans follows from the pool size
+constexpr u32 CAPACITY_PER_SERVER = 100;
+constexpr u16 INSTANCE_SIZE = 10;
+
+static ServerInformation MakeServer(u32 index)
+{
+    ServerInformation info;
+    info.entity = static_cast<entt::entity>(index);
+    info.type = AddressType::WORLD;
+    info.realmId = 0;
+    info.address = 0x0A000000 + index;
+    info.port = static_cast<u16>(8000 + index % 1000);
+    return info;
+}
+
+// What ServerPool looked like as a single array, every field of a server next to each other
+struct AoSServer
+{
+    AoSServer(const ServerEntry& inEntry, f32 inWeight, u32 inLoad, u8 inFlags) : entry(inEntry), weight(inWeight), load(inLoad), flags(inFlags) { }
+
+    ServerEntry entry;
+    f32 weight;
+    u32 load;
+    u8 flags;
+};
+
+// PlacementSingleton::FindFit over the array of structs, with the key placement uses for best fit
+static u32 FindFitAoS(const std::vector<AoSServer>& servers, u16 size)
+{
+    u32 numServers = static_cast<u32>(servers.size());
+
+    u32 bestKey = PlacementSingleton::NO_FIT;
+    for (u32 i = 0; i < numServers; i++)
+        bestKey = std::min(bestKey, PlacementSingleton::GetFitKey(CAPACITY_PER_SERVER, servers[i].weight, servers[i].load, servers[i].flags, size, true));
+
+    if (bestKey == PlacementSingleton::NO_FIT)
+        return ServerPool::INVALID_POSITION;
+
+    for (u32 i = 0; i < numServers; i++)
+    {
+        if (PlacementSingleton::GetFitKey(CAPACITY_PER_SERVER, servers[i].weight, servers[i].load, servers[i].flags, size, true) == bestKey)
+            return i;
+    }
+
+    return ServerPool::INVALID_POSITION;
+}
+
+// The part of SelectNext that depends on the layout, stepping past excluded servers
+static u32 NextSelectableSoA(const ServerPool& pool, u32& cursor)
+{
+    const u8* flags = pool.flags.data();
+    u32 numServers = pool.Size();
+
+    for (u32 i = 0; i < numServers; i++)
+    {
+        if (cursor >= numServers)
+            cursor = 0;
+
+        u32 position = cursor++;
+        if (!(flags[position] & ServerPool::FLAG_EXCLUDED))
+            return position;
+    }
+
+    return ServerPool::INVALID_POSITION;
+}
+static u32 NextSelectableAoS(const std::vector<AoSServer>& servers, u32& cursor)
+{
+    u32 numServers = static_cast<u32>(servers.size());
+
+    for (u32 i = 0; i < numServers; i++)
+    {
+        if (cursor >= numServers)
+            cursor = 0;
+
+        u32 position = cursor++;
+        if (!(servers[position].flags & ServerPool::FLAG_EXCLUDED))
+            return position;
+    }
+
+    return ServerPool::INVALID_POSITION;
+}
+
+template <typename Func>
+static f64 TimePerOp(u64 numOps, Func&& func)
+{
+    // Warm up on a tenth of the runs first
+    for (u64 i = 0; i < numOps / 10; i++)
+        func();
+
+    auto start = std::chrono::steady_clock::now();
+    for (u64 i = 0; i < numOps; i++)
+        func();
+
+    return std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - start).count() / numOps;
+}
+
+// Instance servers at mixed loads, with every tenth draining and 90% of the rest drained for the selection scan to step past
+static void CompareLayouts(u32 numServers, u64& checksum)
+{
+    entt::registry registry;
+    LoadBalanceSingleton& loadBalanceSingleton = registry.set<LoadBalanceSingleton>(registry);
+    PlacementSingleton& placementSingleton = registry.set<PlacementSingleton>();
+    placementSingleton.capacityPerServer = CAPACITY_PER_SERVER;
+
+    for (u32 i = 0; i < numServers; i++)
+    {
+        ServerInformation info = MakeServer(i);
+        info.type = AddressType::INSTANCE;
+        loadBalanceSingleton.Add(info);
+    }
+
+    ServerPool& pool = *loadBalanceSingleton.GetPool(AddressType::INSTANCE, 0);
+    for (u32 i = 0; i < numServers; i++)
+    {
+        pool.loads[i] = (i * 37) % CAPACITY_PER_SERVER;
+        if (i % 10 == 0)
+            pool.flags[i] |= ServerPool::FLAG_DRAINING;
+    }
+
+    std::vector<AoSServer> servers;
+    servers.reserve(numServers);
+    for (u32 i = 0; i < numServers; i++)
+        servers.emplace_back(pool.entries[i], pool.weights[i], pool.loads[i], pool.flags[i]);
+
+    u64 numFitScans = std::max<u64>(LAYOUT_SERVERS_PER_RUN / numServers, 100);
+    f64 fitSoA = TimePerOp(numFitScans, [&]() { checksum += placementSingleton.FindFit(pool, INSTANCE_SIZE, true); });
+    f64 fitAoS = TimePerOp(numFitScans, [&]() { checksum += FindFitAoS(servers, INSTANCE_SIZE); });
+
+    // Place reserves on the server it picks, releasing it right away keeps every scan looking at the same loads
+    f64 place = TimePerOp(numFitScans, [&]()
+    {
+        if (const ServerEntry* serverEntry = placementSingleton.Place(loadBalanceSingleton, 0, INSTANCE_SIZE))
+        {
+            placementSingleton.Release(loadBalanceSingleton, 0, serverEntry->info.address, serverEntry->info.port, INSTANCE_SIZE);
+            checksum += serverEntry->info.port;
+        }
+    });
+
+    for (u32 i = 0; i < numServers; i++)
+    {
+        if (i % 10 < DRAINED_OUT_OF_TEN)
+        {
+            pool.flags[i] |= ServerPool::FLAG_DRAINING;
+            servers[i].flags |= ServerPool::FLAG_DRAINING;
+        }
+    }
+
+    u32 cursorSoA = 0;
+    u32 cursorAoS = 0;
+    f64 selectSoA = TimePerOp(NUM_SELECTIONS, [&]() { checksum += NextSelectableSoA(pool, cursorSoA); });
+    f64 selectAoS = TimePerOp(NUM_SELECTIONS, [&]() { checksum += NextSelectableAoS(servers, cursorAoS); });
+
+    constexpr size_t selectBytesSoA = sizeof(u8);
+    constexpr size_t fitBytesSoA = sizeof(f32) + sizeof(u32) + sizeof(u8);
+
+    std::printf("%-8u %-6s %10.1f %10.1f %10zu %10zu\n", numServers, "SoA", selectSoA, fitSoA, selectBytesSoA, fitBytesSoA);
+    std::printf("%-8u %-6s %10.1f %10.1f %10zu %10zu\n", numServers, "AoS", selectAoS, fitAoS, sizeof(AoSServer), sizeof(AoSServer));
+    std::printf("%-8u %-6s %10s %10.1f\n", numServers, "Place", "", place);
+}
+
+// Returns nanoseconds per selection, the checksum keeps the selections from being optimized out
+static f64 TimeSelection(LoadBalanceSingleton& loadBalanceSingleton, u64& checksum)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (u32 i = 0; i < NUM_SELECTIONS; i++)
+    {
+        if (const ServerEntry* serverEntry = loadBalanceSingleton.Select(AddressType::WORLD, 0))
+            checksum += serverEntry->info.port;
+    }
+
+    return std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_SELECTIONS;
+}
+
+int main()
+{
+    entt::registry registry;
+    LoadBalanceSingleton& loadBalanceSingleton = registry.set<LoadBalanceSingleton>(registry);
+
+    i64 liveBytesBefore = AllocationCounter::GetLiveBytes();
+    for (u32 i = 0; i < NUM_BACKENDS; i++)
+    {
+        loadBalanceSingleton.Add(MakeServer(i));
+    }
+    f64 bytesPerEntry = static_cast<f64>(AllocationCounter::GetLiveBytes() - liveBytesBefore) / NUM_BACKENDS;
+
+    const ServerPool* pool = loadBalanceSingleton.GetPool(AddressType::WORLD, 0);
+    size_t arrayBytes = pool->weights.capacity() * sizeof(f32) + pool->loads.capacity() * sizeof(u32) + pool->flags.capacity() * sizeof(u8) + pool->entries.capacity() * sizeof(ServerEntry);
+    f64 arrayBytesPerEntry = static_cast<f64>(arrayBytes) / NUM_BACKENDS;
+
+    u64 checksum = 0;
+    TimeSelection(loadBalanceSingleton, checksum);
+    f64 selectableNs = TimeSelection(loadBalanceSingleton, checksum);
+
+    for (u32 i = 0; i < NUM_BACKENDS; i++)
+    {
+        if (i % 10 < DRAINED_OUT_OF_TEN)
+            loadBalanceSingleton.SetDraining(AddressType::WORLD, static_cast<entt::entity>(i), 0, true);
+    }
+
+    TimeSelection(loadBalanceSingleton, checksum);
+    f64 drainingNs = TimeSelection(loadBalanceSingleton, checksum);
+
+    std::printf("%u backends, %u selections per run (checksum %llu)\n", NUM_BACKENDS, NUM_SELECTIONS, static_cast<unsigned long long>(checksum));
+    std::printf("%-32s %10.1f\n", "bytes/entry", bytesPerEntry);
+    std::printf("%-32s %10.1f\n", "bytes/entry in the pool arrays", arrayBytesPerEntry);
+    std::printf("%-32s %10.1f\n", "select ns/op", selectableNs);
+    std::printf("%-32s %10.1f\n", "select ns/op, 90% draining", drainingNs);
+
+    std::printf("\nLayouts, selection scan with 90%% draining and fit scan in ns/op, bytes each scan reads per server\n");
+    std::printf("%-8s %-6s %10s %10s %10s %10s\n", "servers", "layout", "select", "fit", "select B", "fit B");
+    for (u32 numServers : LAYOUT_POOL_SIZES)
+        CompareLayouts(numServers, checksum);
+
+    std::printf("(checksum %llu)\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
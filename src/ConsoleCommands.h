@@ -28,12 +28,17 @@
 #include <sstream>
 #include <iterator>
 #include <functional>
+#include <algorithm>
 
 #include <Utils/StringUtils.h>
 #include <Utils/DebugHandler.h>
 
 #include "ConsoleCommands/QuitCommand.h"
 #include "ConsoleCommands/PingCommand.h"
+#include "ConsoleCommands/CaptureCommand.h"
+#include "ConsoleCommands/ZonesCommand.h"
+#include "ConsoleCommands/DrainCommand.h"
+#include "ConsoleCommands/TopCommand.h"
 
 class ConsoleCommandHandler
 {
@@ -42,6 +47,11 @@ public:
     {
         RegisterCommand("quit"_h, &QuitCommand);
         RegisterCommand("ping"_h, &PingCommand);
+        RegisterCommand("capture"_h, &CaptureCommand);
+        RegisterCommand("replay"_h, &ReplayCommand);
+        RegisterCommand("zones"_h, &ZonesCommand);
+        RegisterCommand("drain"_h, &DrainCommand);
+        RegisterCommand("top"_h, &TopCommand);
     }
 
     void HandleCommand(EngineLoop& engineLoop, std::string& command)
@@ -50,6 +60,7 @@ public:
             return;
 
         std::vector<std::string> splitCommand = StringUtils::SplitString(command);
+        std::transform(splitCommand[0].begin(), splitCommand[0].end(), splitCommand[0].begin(), ::tolower); // Only the command is case insensitive, arguments such as file paths are not
         u32 hashedCommand = StringUtils::fnv1a_32(splitCommand[0].c_str(), splitCommand[0].size());
 
         auto commandHandler = commandHandlers.find(hashedCommand);
@@ -0,0 +1,65 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <Utils/Message.h>
+#include <Utils/DebugHandler.h>
+#include "../EngineLoop.h"
+
+// capture start <file> | capture stop
+void CaptureCommand(EngineLoop& engineLoop, std::vector<std::string> subCommands)
+{
+    Message captureMessage;
+
+    if (subCommands.size() == 2 && subCommands[0] == "start")
+    {
+        captureMessage.code = MSG_IN_CAPTURE_START;
+        captureMessage.message = new std::string(subCommands[1]);
+    }
+    else if (subCommands.size() == 1 && subCommands[0] == "stop")
+    {
+        captureMessage.code = MSG_IN_CAPTURE_STOP;
+    }
+    else
+    {
+        DebugHandler::PrintWarning("Usage: capture start <file> | capture stop");
+        return;
+    }
+
+    engineLoop.PassMessage(captureMessage);
+}
+
+// replay <file> [fast]
+void ReplayCommand(EngineLoop& engineLoop, std::vector<std::string> subCommands)
+{
+    if (subCommands.size() == 0 || subCommands.size() > 2 || (subCommands.size() == 2 && subCommands[1] != "fast"))
+    {
+        DebugHandler::PrintWarning("Usage: replay <file> [fast]");
+        return;
+    }
+
+    Message replayMessage;
+    replayMessage.code = subCommands.size() == 2 ? MSG_IN_REPLAY_FAST : MSG_IN_REPLAY;
+    replayMessage.message = new std::string(subCommands[0]);
+    engineLoop.PassMessage(replayMessage);
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <Utils/Message.h>
+#include <Utils/DebugHandler.h>
+#include "../EngineLoop.h"
+
+// drain <address>:<port> [off], a draining server keeps its current players but gets no new selections
+void DrainCommand(EngineLoop& engineLoop, std::vector<std::string> subCommands)
+{
+    if (subCommands.size() == 0 || subCommands.size() > 2 || (subCommands.size() == 2 && subCommands[1] != "off"))
+    {
+        DebugHandler::PrintWarning("Usage: drain <address>:<port> [off]");
+        return;
+    }
+
+    Message drainMessage;
+    drainMessage.code = subCommands.size() == 2 ? MSG_IN_UNDRAIN : MSG_IN_DRAIN;
+    drainMessage.message = new std::string(subCommands[0]);
+    engineLoop.PassMessage(drainMessage);
+}
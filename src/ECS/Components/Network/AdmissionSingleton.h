@@ -0,0 +1,185 @@
+#pragma once
+#include <NovusTypes.h>
+#include <algorithm>
+#include <cmath>
+
+class NetClient;
+
+// Status byte of SMSG_SEND_ADDRESS and of each SMSG_SEND_ADDRESS_BULK entry, BUSY is followed by a u16 retry after in milliseconds
+// QUEUED is followed by a u32 queue position and a u16 estimated wait in seconds, the address follows later as its own SMSG_SEND_ADDRESS
+// TIMED_OUT ends a queued request which was not served before its deadline
+enum class AddressStatus : u8
+{
+    NOT_FOUND = 0,
+    SUCCESS = 1,
+    BUSY = 2,
+    QUEUED = 3,
+    TIMED_OUT = 4
+};
+
+struct TokenBucket
+{
+    f32 tokens = 0.0f;
+    u64 lastRefill = 0; // Milliseconds, an f32 in seconds steps by more than a tick after a few days of uptime
+};
+
+struct ConnectionAdmission
+{
+    TokenBucket bucket;
+    robin_hood::unordered_map<u64, TokenBucket> requesterBuckets; // Requester ids are whatever the sender writes, they only mean something within its connection
+};
+
+/*
+    Admission control for address requests.
+    Every request is charged to its connection, requests which carry a requester id are also charged to that requester's bucket within the connection.
+    A sender making up a new requester id for every request is still held to its connection's rate, and can only create maxRequestersPerConnection buckets.
+    While the engine overruns its tick budget every request costs more tokens, requesters which were sending the most are throttled first.
+*/
+struct AdmissionSingleton
+{
+    // Set on the AddressType byte of a request when a u64 requester id follows it
+    static constexpr u8 REQUESTER_ID_FLAG = 0x80;
+
+    // A requester which has not sent anything for this long has a full bucket again and is dropped
+    static constexpr f32 IDLE_BUCKET_TIMEOUT = 60.0f;
+
+    AdmissionSingleton()
+    {
+        connections.reserve(8);
+    }
+
+    // Returns false if the request should be answered with AddressStatus::BUSY, now is TimeSingleton::lifeTimeInWholeMS
+    inline bool Admit(const NetClient* connection, bool hasRequesterId, u64 requesterId, u64 now, u16& retryAfterMs)
+    {
+        bool isNewConnection = connections.find(connection) == connections.end();
+        ConnectionAdmission& connectionAdmission = connections[connection];
+        Refill(connectionAdmission.bucket, isNewConnection, connectionRate, connectionBurst, now);
+
+        // Past the cap new requester ids are only held to the connection's bucket, the ones it already has keep theirs
+        TokenBucket* requesterBucket = nullptr;
+        if (hasRequesterId)
+        {
+            auto& requesterBuckets = connectionAdmission.requesterBuckets;
+            auto itr = requesterBuckets.find(requesterId);
+            if (itr != requesterBuckets.end())
+            {
+                requesterBucket = &itr->second;
+                Refill(*requesterBucket, false, requesterRate, requesterBurst, now);
+            }
+            else if (requesterBuckets.size() < maxRequestersPerConnection)
+            {
+                requesterBucket = &requesterBuckets[requesterId];
+                Refill(*requesterBucket, true, requesterRate, requesterBurst, now);
+            }
+            else
+            {
+                numOverRequesterLimit++;
+            }
+        }
+
+        f32 cost = isShedding ? shedCostMultiplier : 1.0f;
+        f32 retryAfter = GetRetryAfter(connectionAdmission.bucket, cost, connectionRate);
+        if (requesterBucket)
+            retryAfter = std::max(retryAfter, GetRetryAfter(*requesterBucket, cost, requesterRate));
+
+        if (retryAfter <= 0.0f)
+        {
+            connectionAdmission.bucket.tokens -= cost;
+            if (requesterBucket)
+                requesterBucket->tokens -= cost;
+
+            numAdmitted++;
+            return true;
+        }
+
+        retryAfterMs = static_cast<u16>(std::min(retryAfter, 65535.0f));
+        numRejected++;
+        return false;
+    }
+
+    // Called once per tick with the time the tick spent working, shedding starts when it overruns the budget and stops after a few ticks within it
+    inline void UpdateLoad(f32 tickWorkTime, f32 tickBudget)
+    {
+        if (tickWorkTime > tickBudget * overrunThreshold)
+        {
+            isShedding = true;
+            ticksWithinBudget = 0;
+        }
+        else if (isShedding && ++ticksWithinBudget >= recoveryTicks)
+        {
+            isShedding = false;
+        }
+    }
+
+    // Scheduled every IDLE_BUCKET_TIMEOUT on TimerSingleton, context is the AdmissionSingleton and now is in milliseconds
+    inline static void OnPruneTimer(void* context, u64 /*data*/, u64 now)
+    {
+        static_cast<AdmissionSingleton*>(context)->PruneIdle(now);
+    }
+    inline void PruneIdle(u64 now)
+    {
+        constexpr u64 idleTimeoutMs = static_cast<u64>(IDLE_BUCKET_TIMEOUT * 1000.0f);
+
+        for (auto& connection : connections)
+        {
+            auto& requesterBuckets = connection.second.requesterBuckets;
+            for (auto itr = requesterBuckets.begin(); itr != requesterBuckets.end();)
+            {
+                if (now - itr->second.lastRefill > idleTimeoutMs)
+                    itr = requesterBuckets.erase(itr);
+                else
+                    ++itr;
+            }
+        }
+    }
+
+    inline void RemoveConnection(const NetClient* connection)
+    {
+        connections.erase(connection);
+    }
+
+    // Requests per second and burst size
+    f32 connectionRate = 10000.0f;
+    f32 connectionBurst = 20000.0f;
+    f32 requesterRate = 500.0f;
+    f32 requesterBurst = 1000.0f;
+    u32 maxRequestersPerConnection = 4096;
+
+    f32 overrunThreshold = 0.8f; // Fraction of the tick budget the engine may spend working before we start shedding
+    f32 shedCostMultiplier = 4.0f;
+    u32 recoveryTicks = 5;
+
+    bool isShedding = false;
+    u32 ticksWithinBudget = 0;
+
+    u64 numAdmitted = 0;
+    u64 numRejected = 0;
+    u64 numOverRequesterLimit = 0; // Requests with a new requester id from a connection which had no buckets left for it
+
+    robin_hood::unordered_map<const NetClient*, ConnectionAdmission> connections;
+
+private:
+    inline static void Refill(TokenBucket& bucket, bool isNew, f32 rate, f32 burst, u64 now)
+    {
+        if (isNew)
+        {
+            bucket.tokens = burst;
+        }
+        else
+        {
+            f32 elapsed = static_cast<f32>(now - bucket.lastRefill) / 1000.0f;
+            bucket.tokens = std::min(burst, bucket.tokens + elapsed * rate);
+        }
+
+        bucket.lastRefill = now;
+    }
+
+    // Milliseconds until the bucket holds cost tokens, 0 if it already does
+    inline static f32 GetRetryAfter(const TokenBucket& bucket, f32 cost, f32 rate)
+    {
+        if (bucket.tokens >= cost)
+            return 0.0f;
+
+        return std::ceil((cost - bucket.tokens) / rate * 1000.0f);
+    }
+};
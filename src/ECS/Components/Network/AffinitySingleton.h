@@ -0,0 +1,66 @@
+#pragma once
+#include <NovusTypes.h>
+#include "LoadBalanceSingleton.h"
+#include "../../../Utils/AffinityTable.h"
+
+/*
+    Sends a returning requester back to the server it was last given, so a player reconnecting after a short drop keeps its state warm on that server.
+    Requesters are identified by the requester id sent along with their address request, requests without one always go through normal selection.
+    Entries hold the backend entity, once the server is removed, drained or unhealthy the entry stops matching and the requester is selected anew.
+*/
+struct AffinitySingleton
+{
+    static constexpr u32 DEFAULT_MAX_ENTRIES = 65536;
+    static constexpr f32 DEFAULT_TTL = 120.0f;
+
+    AffinitySingleton()
+    {
+        table.Init(DEFAULT_MAX_ENTRIES, DEFAULT_TTL);
+    }
+
+    inline void EnableType(AddressType type, bool isEnabled)
+    {
+        u32 bit = 1u << static_cast<u8>(type);
+        typeMask = isEnabled ? (typeMask | bit) : (typeMask & ~bit);
+    }
+    inline bool IsEnabled(AddressType type) const { return (typeMask & (1u << static_cast<u8>(type))) != 0; }
+
+    // Returns nullptr if the requester has no live affinity, a hit is recorded as an assignment and refreshes the entry's ttl
+    inline const ServerEntry* Select(LoadBalanceSingleton& loadBalanceSingleton, AddressType type, u8 realmId, u64 requesterId, f32 now)
+    {
+        u16 scope = GetScope(type, realmId);
+        entt::entity backend = table.Lookup(requesterId, scope, now);
+        if (backend == entt::null)
+        {
+            numMisses++;
+            return nullptr;
+        }
+
+        const ServerEntry* serverEntry = loadBalanceSingleton.FindSelectable(backend);
+        if (!serverEntry)
+        {
+            table.Erase(requesterId, scope);
+            numMisses++;
+            return nullptr;
+        }
+
+        loadBalanceSingleton.RecordAssignment(*serverEntry);
+        numHits++;
+        return serverEntry;
+    }
+    inline void Remember(AddressType type, u8 realmId, u64 requesterId, const ServerEntry& serverEntry, f32 now)
+    {
+        table.Insert(requesterId, GetScope(type, realmId), serverEntry.backend, now);
+    }
+
+    u64 numHits = 0;
+    u64 numMisses = 0;
+
+    AffinityTable table;
+
+private:
+    inline static u16 GetScope(AddressType type, u8 realmId) { return static_cast<u16>((static_cast<u16>(type) << 8) | realmId); }
+
+private:
+    u32 typeMask = 1u << static_cast<u8>(AddressType::WORLD);
+};
@@ -1,9 +1,23 @@
 #pragma once
 #include <NovusTypes.h>
 #include <Utils/srp.h>
+#include "../../../Utils/Sha256.h"
 
 struct AuthenticationSingleton
 {
     std::string username = "";
     SRPUser srp;
-};
\ No newline at end of file
+
+    // Authenticates the UDP endpoint, derived from the SRP session key every time we log in so it changes along with the session
+    // The upstream server derives the same key from its side of the session and hands it to the servers it lets use the endpoint
+    Sha256::Digest datagramKey = {};
+    bool hasDatagramKey = false;
+
+    inline void DeriveDatagramKey()
+    {
+        static constexpr char label[] = "NovusCore LoadBalancer Datagram v1";
+
+        Sha256::Hmac(srp.sessionKey, sizeof(srp.sessionKey), label, sizeof(label) - 1, datagramKey.data());
+        hasDatagramKey = true;
+    }
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Networking/NetStructures.h>
+#include <entity/fwd.hpp>
+
+/*
+    Every backend server known to LoadBalanceSingleton is also an entity in the game registry.
+    The pools keep what selection scans (weights, loads, flags) in their own arrays, everything else about a backend lives in these components.
+*/
+
+// Which pool the backend is in, serverEntity is the entity the backend was announced with
+struct BackendLocation
+{
+    AddressType type;
+    u8 realmId;
+    entt::entity serverEntity;
+};
+
+// Assignment counters, RecordAssignment bumps them and BackendStatsSystem rolls the per second rate
+struct BackendStats
+{
+    u64 totalAssignments = 0;
+    u32 windowAssignments = 0;
+    f32 assignmentsPerSecond = 0.0f;
+    f32 lastAssignedAt = -1.0f;
+};
+
+// Passive health from the failures requesters report, BackendHealthSystem takes a backend out of selection when they pile up
+struct BackendHealth
+{
+    u64 failureReports = 0;
+    u32 windowFailures = 0;
+    f32 windowStart = 0.0f;
+
+    bool isHealthy = true;
+    f32 unhealthyUntil = 0.0f;
+};
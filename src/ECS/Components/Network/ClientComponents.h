@@ -0,0 +1,51 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+
+class PosixTransport;
+class DatagramTransport;
+
+/*
+    Every connection accepted by ClientListenerSystem is an entity in the game registry, it is destroyed along with the connection.
+    So is every address DatagramSystem has received a valid request from, until it has been quiet for DatagramSingleton::peerIdleTimeout.
+*/
+
+struct ClientConnection
+{
+    std::shared_ptr<PosixTransport> transport;
+    f32 acceptedAt = 0.0f;
+    f32 lastPacketAt = 0.0f; // Idle connections are closed after ClientListenerSingleton::idleTimeout
+    u64 numPackets = 0;
+};
+
+struct DatagramPeer
+{
+    std::shared_ptr<DatagramTransport> transport;
+    u64 peerKey = 0; // Key in DatagramSingleton::peers
+    f32 lastRequestAt = 0.0f;
+    u64 numRequests = 0;
+
+    // Sliding replay window over DatagramProtocol::GetSequence, bit n is set once highestSequence - n has been accepted
+    u64 highestSequence = 0;
+    u64 replayWindow = 0;
+
+    // Returns false for a sequence that was already accepted or has fallen behind the window
+    bool TryAcceptSequence(u64 sequence)
+    {
+        if (sequence > highestSequence)
+        {
+            u64 shift = sequence - highestSequence;
+            replayWindow = shift >= 64 ? 0 : replayWindow << shift;
+            replayWindow |= 1;
+            highestSequence = sequence;
+            return true;
+        }
+
+        u64 offset = highestSequence - sequence;
+        if (offset >= 64 || (replayWindow & (1ull << offset)))
+            return false;
+
+        replayWindow |= 1ull << offset;
+        return true;
+    }
+};
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef _WIN32
+#include <NovusTypes.h>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <entity/fwd.hpp>
+#include "../../../Network/ClientListener.h"
+#include "../../../Network/PacketLanes.h"
+
+/*
+    Lets region servers, auth servers and tooling look addresses up on the load balancer directly rather than through the upstream server.
+    Direct clients share the packet handlers with the upstream connection but may only send address requests, anything else closes the connection.
+    The connections are entities with a ClientConnection, ClientListenerSystem frames and dispatches them one after the other through the shared lanes.
+*/
+struct ClientListenerSingleton
+{
+    // Large enough for the biggest packet the framing accepts
+    static constexpr size_t READ_BUFFER_SIZE = 16384;
+    static constexpr i32 BACKLOG = 128;
+
+    bool Listen(const std::string& address, u16 port)
+    {
+        return listener.Listen(address, port, BACKLOG);
+    }
+
+    ClientListener listener;
+    PacketLanes packetLanes;
+    // Reused every tick, pollEntities[i] is the connection polled by pollFds[i]
+    std::vector<pollfd> pollFds;
+    std::vector<entt::entity> pollEntities;
+
+    u32 maxConnections = 1024;
+    u32 maxAcceptsPerTick = 64;
+    f32 idleTimeout = 120.0f; // 0 keeps idle connections open
+
+    u32 numConnections = 0;
+    u64 numAccepted = 0;
+    u64 numRejected = 0; // Accepted while at maxConnections and closed right away
+    u64 numClosed = 0;
+};
+#endif // _WIN32
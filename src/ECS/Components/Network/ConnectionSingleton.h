@@ -1,15 +1,54 @@
 #pragma once
 #include <NovusTypes.h>
-#include <Utils/ConcurrentQueue.h>
+#include <atomic>
 #include <Networking/NetPacket.h>
 #include <Networking/NetClient.h>
+#include "../../../Network/PacketLanes.h"
+#include "../../../Network/Transport/NetTransport.h"
+#include "../../../Utils/AsyncLogger.h"
 
 struct ConnectionSingleton
 {
-    ConnectionSingleton() : packetQueue(256) { }
-
-    std::shared_ptr<NetClient> netClient;
+    // Upstream connection
+    std::shared_ptr<NetTransport> transport;
     bool didHandleDisconnect = false;
 
-    moodycamel::ConcurrentQueue<std::shared_ptr<NetPacket>> packetQueue;
-};
\ No newline at end of file
+    PacketLanes packetLanes;
+
+    // The read and dispatch stages of the update run side by side, these tell each stage when the other is done for the tick
+    // Both are reset by the flush stage, which runs once both have finished
+    bool isPipelined = true; // False when the executor has a single worker or we are simulating, the stages then run one after the other
+    std::atomic<bool> isFramingDone { false };
+    std::atomic<bool> isDispatchDone { false };
+    bool isReadPaused = false; // Set by the flush stage from the outbound queue's watermarks
+
+    // Every client handlers can be called with maps to the transport its responses go out on
+    inline void RegisterTransport(NetTransport* netTransport)
+    {
+        transports[netTransport->GetClient().get()] = netTransport;
+    }
+    inline void UnregisterTransport(NetTransport* netTransport)
+    {
+        transports.erase(netTransport->GetClient().get());
+    }
+    inline NetTransport* GetTransport(const std::shared_ptr<NetClient>& netClient)
+    {
+        auto itr = transports.find(netClient.get());
+        return itr != transports.end() ? itr->second : nullptr;
+    }
+    inline void Send(const std::shared_ptr<NetClient>& netClient, std::shared_ptr<Bytebuffer> buffer)
+    {
+        NetTransport* transport = GetTransport(netClient);
+        if (!transport)
+            return;
+
+        // Reads pause long before this, if we still hit the capacity the peer has stopped reading entirely
+        if (!transport->Enqueue(std::move(buffer)))
+        {
+            AsyncLogger::PrintError("[Network]: Outbound queue exceeded its capacity (%llu bytes queued), closing connection", static_cast<unsigned long long>(transport->GetOutboundQueue().GetDepth()));
+            transport->RequestClose();
+        }
+    }
+
+    robin_hood::unordered_map<const NetClient*, NetTransport*> transports;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef _WIN32
+#include <NovusTypes.h>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include <entity/fwd.hpp>
+#include "../../../Network/UdpEndpoint.h"
+#include "../../../Network/DatagramProtocol.h"
+
+/*
+    The UDP endpoint for single address lookups, see DatagramProtocol for the format.
+    A lost datagram only delays the request it carried, where one lost segment on a TCP connection holds up every request behind it.
+    Each requester address becomes a DatagramPeer entity on its first valid, fresh request, it is what admission and the login queue know the requester by.
+    The peer's replay window rejects requests it has already seen, maxClockSkew rejects the ones old enough to have outlived a peer's window.
+*/
+struct DatagramSingleton
+{
+    static inline u64 MakePeerKey(const sockaddr_in& address)
+    {
+        return (static_cast<u64>(address.sin_addr.s_addr) << 16) | address.sin_port;
+    }
+
+    bool Open(const std::string& address, u16 port)
+    {
+        return endpoint.Open(address, port, DatagramProtocol::MAX_DATAGRAM_SIZE);
+    }
+
+    UdpEndpoint endpoint;
+    robin_hood::unordered_map<u64, entt::entity> peers;
+    std::vector<entt::entity> expiredPeers; // Reused by every expiry pass
+
+    u32 maxPeers = 4096; // Requests from new addresses are dropped beyond this
+    u32 maxBatchesPerTick = 16; // Bounds the work per tick, the rest waits in the socket's receive buffer
+    f32 peerIdleTimeout = 900.0f; // Longer than LoginQueueSingleton::maxWaitTime, so a queued request still finds its requester
+    u32 maxClockSkew = 30; // Seconds a request's timestamp may be off from our clock, has to stay below peerIdleTimeout
+    f32 expiryInterval = 5.0f;
+    f32 nextExpiryAt = 0.0f;
+
+    u64 numRequests = 0;
+    u64 numRejected = 0; // No key yet, or the tag did not match
+    u64 numStale = 0; // Timestamp outside maxClockSkew
+    u64 numReplayed = 0; // Sequence already seen or behind the peer's replay window
+    u64 numMalformed = 0;
+    u64 numOverPeerLimit = 0;
+};
+#endif // _WIN32
@@ -1,8 +1,11 @@
 #pragma once
 #include <NovusTypes.h>
 #include <Networking/NetStructures.h>
-#include <entity/fwd.hpp>
+#include <entity/registry.hpp>
 #include <vector>
+#include <cstring>
+#include <algorithm>
+#include "BackendComponents.h"
 
 #pragma pack(push, 1)
 struct ServerInformation
@@ -14,243 +17,797 @@ struct ServerInformation
     u16 port = 0;
 };
 #pragma pack(pop)
+
+// Pre-encoded SMSG_SEND_ADDRESS payload prefix (status, address, port) for a server, rebuilt whenever the server is added or updated
+struct AddressResponseTemplate
+{
+    static constexpr size_t SIZE = sizeof(u8) + sizeof(u32) + sizeof(u16);
+
+    inline void Build(const ServerInformation& info)
+    {
+        data[0] = 1; // Status
+        std::memcpy(&data[1], &info.address, sizeof(u32));
+        std::memcpy(&data[5], &info.port, sizeof(u16));
+    }
+
+    u8 data[SIZE] = { 0 };
+};
+
+struct ServerEntry
+{
+    ServerEntry(const ServerInformation& inInfo) : info(inInfo)
+    {
+        response.Build(info);
+    }
+
+    ServerInformation info;
+    AddressResponseTemplate response;
+
+    entt::entity backend = entt::null; // The backend's entity in the game registry, carries its BackendComponents
+
+    // Slow start, a server added while we are running ramps up from slowStartMinWeight to its full share over the slow start window
+    f32 addedAt = 0.0f;
+    mutable f32 slowStartCredit = 0.0f;
+};
+
+/*
+    Servers of one type (and realm), stored as a structure of arrays.
+    Everything selection and placement scan has its own contiguous array, position i of every array is the same server.
+    The ServerEntry holds what a handler needs once a server has been picked, the rest of a server's state lives on its backend entity. positions lets us find a server by entity without scanning the pool.
+*/
+struct ServerPool
+{
+    static constexpr u32 INVALID_POSITION = ~0u;
+
+    // Bits of flags
+    static constexpr u8 FLAG_DRAINING = 1 << 0;
+    static constexpr u8 FLAG_RAMPING = 1 << 1;
+    static constexpr u8 FLAG_UNHEALTHY = 1 << 2;
+    static constexpr u8 FLAG_EXCLUDED = FLAG_DRAINING | FLAG_UNHEALTHY; // Skipped by every selection
+
+    std::vector<f32> weights; // Share of a full server's selections, below 1 while the server is in its slow start window
+    std::vector<u32> loads; // Instance capacity reserved by placement
+    std::vector<u8> flags;
+
+    std::vector<ServerEntry> entries;
+    robin_hood::unordered_map<entt::entity, u32> positions;
+
+    u32 cursor = 0; // Round robin position, pools grow into the tens of thousands so this can't be a u8
+    u32 numRamping = 0;
+
+    inline u32 Size() const { return static_cast<u32>(entries.size()); }
+    inline bool IsDraining(u32 position) const { return (flags[position] & FLAG_DRAINING) != 0; }
+    inline bool IsExcluded(u32 position) const { return (flags[position] & FLAG_EXCLUDED) != 0; }
+
+    inline u32 Find(entt::entity entity) const
+    {
+        auto itr = positions.find(entity);
+        return itr != positions.end() ? itr->second : INVALID_POSITION;
+    }
+
+    inline void Reserve(size_t size)
+    {
+        weights.reserve(size);
+        loads.reserve(size);
+        flags.reserve(size);
+        entries.reserve(size);
+        positions.reserve(size);
+    }
+};
+
 struct LoadBalanceSingleton
 {
-    LoadBalanceSingleton()
+    // Set on the AddressType byte of a MSG_REQUEST_ADDRESS when a u8 realm id follows it (after the instance size hint), requests without it are for realm 0
+    // MSG_REQUEST_ADDRESS_BULK entries always carry their realm id after the prefix
+    static constexpr u8 REALM_ID_FLAG = 0x20;
+
+    LoadBalanceSingleton(entt::registry& inRegistry) : registry(&inRegistry)
     {
-        authServers.reserve(8);
-        loadBalancers.reserve(8);
-        regionServers.reserve(8);
-        chatServers.reserve(8);
+        authServers.Reserve(8);
+        loadBalancers.Reserve(8);
+        regionServers.Reserve(8);
+        chatServers.Reserve(8);
 
         realmServersMap.reserve(8);
-        realmServersIndex.reserve(8);
-
         worldServersMap.reserve(8);
-        worldServersIndex.reserve(8);
-
         instanceServersMap.reserve(8);
-        instanceServersIndex.reserve(8);
+
+        addressIndex.reserve(64);
+        backends.reserve(64);
     }
     
     inline void Clear()
     {
-        authServers.clear();
-        loadBalancers.clear();
-        regionServers.clear();
-        chatServers.clear();
+        version++;
 
-        realmServersMap.clear();
-        realmServersIndex.clear();
+        ForEachPool([this](AddressType, u8, const ServerPool& serverPool)
+        {
+            for (const ServerEntry& serverEntry : serverPool.entries)
+                registry->destroy(serverEntry.backend);
+        });
+
+        authServers = ServerPool();
+        loadBalancers = ServerPool();
+        regionServers = ServerPool();
+        chatServers = ServerPool();
+        authServers.Reserve(8);
+        loadBalancers.Reserve(8);
+        regionServers.Reserve(8);
+        chatServers.Reserve(8);
 
+        realmServersMap.clear();
         worldServersMap.clear();
-        worldServersIndex.clear();
-
         instanceServersMap.clear();
-        instanceServersIndex.clear();
+
+        addressIndex.clear();
+        backends.clear();
+    }
+
+    // A full server list, servers still on it keep their backend, drain state, slow start and placement reservations, the ones missing from it are removed
+    inline void Reconcile(const std::vector<ServerInformation>& servers)
+    {
+        std::vector<entt::entity> listed;
+        listed.reserve(servers.size());
+
+        for (const ServerInformation& info : servers)
+        {
+            Add(info);
+            listed.push_back(info.entity);
+        }
+        std::sort(listed.begin(), listed.end());
+
+        std::vector<BackendLocation> unlisted;
+        for (auto& backend : backends)
+        {
+            if (!std::binary_search(listed.begin(), listed.end(), backend.first))
+                unlisted.push_back(registry->get<BackendLocation>(backend.second));
+        }
+
+        for (const BackendLocation& location : unlisted)
+            Remove(location.type, location.serverEntity, location.realmId);
     }
 
     inline void Remove(AddressType type, entt::entity entity, u8 realmId = 0)
     {
-        std::vector<ServerInformation>* serverInformations = nullptr;
+        version++;
+
+        ServerPool* serverPool = GetPool(type, realmId);
+        if (!serverPool)
+            return;
+
+        u32 position = serverPool->Find(entity);
+        if (position == ServerPool::INVALID_POSITION)
+            return;
+
+        ServerEntry& serverEntry = serverPool->entries[position];
+        registry->destroy(serverEntry.backend);
+        RemoveAddress(serverEntry.info);
+        backends.erase(entity);
+
+        ErasePosition(*serverPool, position);
+    }
+    
+    // slowStart is set for servers that come up while we are running, a full server list describes servers that already carry load
+    template <AddressType type>
+    inline void Add(ServerInformation info, bool slowStart = false)
+    {
+        version++;
+
+        ServerPool* serverPool = nullptr;
 
-        if (type == AddressType::AUTH)
+        if constexpr (type == AddressType::AUTH)
         {
-            serverInformations = &authServers;
+            serverPool = &authServers;
         }
-        else if (type == AddressType::LOADBALANCE)
+        else if constexpr (type == AddressType::LOADBALANCE)
         {
-            serverInformations = &loadBalancers;
+            serverPool = &loadBalancers;
         }
-        else if (type == AddressType::REGION)
+        else if constexpr (type == AddressType::REGION)
         {
-            serverInformations = &regionServers;
+            serverPool = &regionServers;
         }
-        else if (type == AddressType::CHAT)
+        else if constexpr (type == AddressType::CHAT)
         {
-            serverInformations = &chatServers;
+            serverPool = &chatServers;
         }
-        else if (type == AddressType::REALM)
+        else if constexpr (type == AddressType::REALM)
         {
-            serverInformations = &realmServersMap[realmId];
+            serverPool = &GetOrCreateRealmPool(realmServersMap, info.realmId);
         }
-        else if (type == AddressType::WORLD)
+        else if constexpr (type == AddressType::WORLD)
         {
-            serverInformations = &worldServersMap[realmId];
+            serverPool = &GetOrCreateRealmPool(worldServersMap, info.realmId);
         }
-        else if (type == AddressType::INSTANCE)
+        else if constexpr (type == AddressType::INSTANCE)
         {
-            serverInformations = &instanceServersMap[realmId];
+            serverPool = &GetOrCreateRealmPool(instanceServersMap, info.realmId);
         }
 
-        auto itr = std::find_if(serverInformations->begin(), serverInformations->end(), [&entity](const ServerInformation& info) -> bool { return info.entity == entity; });
-        if (itr != serverInformations->end())
+        // A server we already know about is being updated, wherever it was announced before
+        auto backendItr = backends.find(info.entity);
+        if (backendItr != backends.end())
         {
-            serverInformations->erase(itr);
+            // Looked up after the new pool was created, realm pools are nodes of their map and stay where they are
+            BackendLocation& location = registry->get<BackendLocation>(backendItr->second);
+            ServerPool* knownPool = GetPool(location.type, location.realmId);
+            u32 knownPosition = knownPool->Find(info.entity);
+
+            ServerEntry& existing = knownPool->entries[knownPosition];
+            RemoveAddress(existing.info);
+            addressIndex[GetAddressKey(info.address, info.port)] = { type, info.realmId, info.entity };
+
+            // Same type and realm, update its entry in place to keep its position in the rotation and its drain state
+            if (knownPool == serverPool)
+            {
+                existing.info = info;
+                existing.response.Build(info);
+                return;
+            }
+
+            // Its type or realm changed, it moves pools along with its backend, drain state, slow start and placement reservations
+            ServerEntry moved = std::move(existing);
+            moved.info = info;
+            moved.response.Build(info);
+
+            f32 weight = knownPool->weights[knownPosition];
+            u32 load = knownPool->loads[knownPosition];
+            u8 flags = knownPool->flags[knownPosition];
+            ErasePosition(*knownPool, knownPosition);
+
+            location.type = type;
+            location.realmId = info.realmId;
+
+            serverPool->positions[info.entity] = serverPool->Size();
+            serverPool->entries.push_back(std::move(moved));
+            serverPool->weights.push_back(weight);
+            serverPool->loads.push_back(load);
+            serverPool->flags.push_back(flags);
+            serverPool->numRamping += (flags & ServerPool::FLAG_RAMPING) != 0;
+            return;
+        }
+
+        serverPool->positions[info.entity] = serverPool->Size();
+
+        ServerEntry& serverEntry = serverPool->entries.emplace_back(info);
+        serverEntry.backend = CreateBackend(type, info);
+        serverEntry.addedAt = currentTime;
+        backends[info.entity] = serverEntry.backend;
+
+        bool isRamping = slowStart && slowStartWindow > 0.0f;
+        serverPool->weights.push_back(isRamping ? slowStartMinWeight : 1.0f);
+        serverPool->loads.push_back(0);
+        serverPool->flags.push_back(isRamping ? ServerPool::FLAG_RAMPING : 0);
+        serverPool->numRamping += isRamping;
+
+        addressIndex[GetAddressKey(info.address, info.port)] = { type, info.realmId, info.entity };
+    }
+    inline void Add(const ServerInformation& info, bool slowStart = false)
+    {
+        switch (info.type)
+        {
+            case AddressType::AUTH:
+                return Add<AddressType::AUTH>(info, slowStart);
+            case AddressType::REALM:
+                return Add<AddressType::REALM>(info, slowStart);
+            case AddressType::WORLD:
+                return Add<AddressType::WORLD>(info, slowStart);
+            case AddressType::INSTANCE:
+                return Add<AddressType::INSTANCE>(info, slowStart);
+            case AddressType::CHAT:
+                return Add<AddressType::CHAT>(info, slowStart);
+            case AddressType::LOADBALANCE:
+                return Add<AddressType::LOADBALANCE>(info, slowStart);
+            case AddressType::REGION:
+                return Add<AddressType::REGION>(info, slowStart);
+
+            default:
+                return;
         }
     }
-    
     template <AddressType type>
-    inline void Add(ServerInformation info)
+    inline const ServerEntry* Select(u8 realmId = 0)
     {
         if constexpr (type == AddressType::AUTH)
         {
-            authServers.emplace_back(info);
+            return SelectNext(authServers);
         }
         else if constexpr (type == AddressType::LOADBALANCE)
         {
-            loadBalancers.emplace_back(info);
+            return SelectNext(loadBalancers);
         }
         else if constexpr (type == AddressType::REGION)
         {
-            regionServers.emplace_back(info);
+            return SelectNext(regionServers);
         }
         else if constexpr (type == AddressType::CHAT)
         {
-            chatServers.emplace_back(info);
+            return SelectNext(chatServers);
         }
         else if constexpr (type == AddressType::REALM)
         {
-            if (realmServersMap.find(info.realmId) == realmServersMap.end())
-            {
-                realmServersMap[info.realmId] = std::vector<ServerInformation>();
-                realmServersMap[info.realmId].reserve(8);
-                realmServersIndex.push_back(0);
-            }
-
-            realmServersMap[info.realmId].push_back(info);
+            return SelectNext(realmServersMap[realmId]);
         }
         else if constexpr (type == AddressType::WORLD)
         {
-            if (worldServersMap.find(info.realmId) == worldServersMap.end())
-            {
-                worldServersMap[info.realmId] = std::vector<ServerInformation>();
-                worldServersMap[info.realmId].reserve(8);
-            }
-
-            worldServersMap[info.realmId].push_back(info);
+            return SelectNext(worldServersMap[realmId]);
         }
         else if constexpr (type == AddressType::INSTANCE)
         {
-            if (instanceServersMap.find(info.realmId) == instanceServersMap.end())
-            {
-                instanceServersMap[info.realmId] = std::vector<ServerInformation>();
-                instanceServersMap[info.realmId].reserve(8);
-            }
+            return SelectNext(instanceServersMap[realmId]);
+        }
 
-            instanceServersMap[info.realmId].push_back(info);
+        return nullptr;
+    }
+    inline const ServerEntry* Select(AddressType type, u8 realmId = 0)
+    {
+        switch (type)
+        {
+            case AddressType::AUTH:
+                return Select<AddressType::AUTH>(realmId);
+            case AddressType::REALM:
+                return Select<AddressType::REALM>(realmId);
+            case AddressType::WORLD:
+                return Select<AddressType::WORLD>(realmId);
+            case AddressType::INSTANCE:
+                return Select<AddressType::INSTANCE>(realmId);
+            case AddressType::CHAT:
+                return Select<AddressType::CHAT>(realmId);
+            case AddressType::LOADBALANCE:
+                return Select<AddressType::LOADBALANCE>(realmId);
+            case AddressType::REGION:
+                return Select<AddressType::REGION>(realmId);
+
+            default:
+                return nullptr;
         }
     }
     template <AddressType type>
     inline bool Get(ServerInformation& serverInformation, u8 realmId = 0)
     {
-        if constexpr (type == AddressType::AUTH)
+        const ServerEntry* serverEntry = Select<type>(realmId);
+        if (!serverEntry)
+            return false;
+
+        serverInformation = serverEntry->info;
+        return true;
+    }
+    inline bool Get(AddressType type, ServerInformation& serverInformation, u8 realmId = 0)
+    {
+        const ServerEntry* serverEntry = Select(type, realmId);
+        if (!serverEntry)
+            return false;
+
+        serverInformation = serverEntry->info;
+        return true;
+    }
+
+    // Returns nullptr if there has never been a server of this type in the realm
+    inline const ServerPool* GetPool(AddressType type, u8 realmId = 0) const
+    {
+        switch (type)
         {
-            size_t numOf = authServers.size();
-            if (numOf == 0)
-                return false;
+            case AddressType::AUTH:
+                return &authServers;
+            case AddressType::LOADBALANCE:
+                return &loadBalancers;
+            case AddressType::REGION:
+                return &regionServers;
+            case AddressType::CHAT:
+                return &chatServers;
+            case AddressType::REALM:
+                return FindRealmPool(realmServersMap, realmId);
+            case AddressType::WORLD:
+                return FindRealmPool(worldServersMap, realmId);
+            case AddressType::INSTANCE:
+                return FindRealmPool(instanceServersMap, realmId);
+
+            default:
+                return nullptr;
+        }
+    }
+    inline ServerPool* GetPool(AddressType type, u8 realmId = 0)
+    {
+        return const_cast<ServerPool*>(static_cast<const LoadBalanceSingleton*>(this)->GetPool(type, realmId));
+    }
 
-            serverInformation = authServers[authIndex++];
+    inline bool Contains(AddressType type, entt::entity entity) const
+    {
+        const robin_hood::unordered_map<u8, ServerPool>* realmMap = nullptr;
+        if (type == AddressType::REALM)
+            realmMap = &realmServersMap;
+        else if (type == AddressType::WORLD)
+            realmMap = &worldServersMap;
+        else if (type == AddressType::INSTANCE)
+            realmMap = &instanceServersMap;
 
-            // Wrap index around if needed
-            if (authIndex == numOf)
-                authIndex = 0;
+        if (!realmMap)
+        {
+            const ServerPool* serverPool = GetPool(type);
+            return serverPool && serverPool->Find(entity) != ServerPool::INVALID_POSITION;
         }
-        else if constexpr (type == AddressType::LOADBALANCE)
+
+        for (auto& realm : *realmMap)
         {
-            size_t numOf = loadBalancers.size();
-            if (numOf == 0)
-                return false;
+            if (realm.second.Find(entity) != ServerPool::INVALID_POSITION)
+                return true;
+        }
 
-            serverInformation = loadBalancers[loadBalanceIndex++];
+        return false;
+    }
 
-            // Wrap index around if needed
-            if (loadBalanceIndex == numOf)
-                loadBalanceIndex = 0;
-        }
-        else if constexpr (type == AddressType::REGION)
+    // Address is in network byte order, returns nullptr if no server is known by it
+    inline const ServerEntry* FindByAddress(u32 address, u16 port) const
+    {
+        auto itr = addressIndex.find(GetAddressKey(address, port));
+        if (itr == addressIndex.end())
+            return nullptr;
+
+        const BackendLocation& location = itr->second;
+        const ServerPool* serverPool = GetPool(location.type, location.realmId);
+        if (!serverPool)
+            return nullptr;
+
+        u32 position = serverPool->Find(location.serverEntity);
+        return position != ServerPool::INVALID_POSITION ? &serverPool->entries[position] : nullptr;
+    }
+    // Backend entities are destroyed when their server is removed, returns nullptr for a stale handle and for a server selection currently skips
+    inline const ServerEntry* FindSelectable(entt::entity backend) const
+    {
+        if (backend == entt::null || !registry->valid(backend))
+            return nullptr;
+
+        const BackendLocation& location = registry->get<BackendLocation>(backend);
+        const ServerPool* serverPool = GetPool(location.type, location.realmId);
+        if (!serverPool)
+            return nullptr;
+
+        u32 position = serverPool->Find(location.serverEntity);
+        if (position == ServerPool::INVALID_POSITION || serverPool->IsExcluded(position))
+            return nullptr;
+
+        return &serverPool->entries[position];
+    }
+    // Ramping servers accumulate their weight as credit every time their turn comes up and are only selected once it adds up to a whole turn
+    inline bool TakeSlowStartTurn(const ServerPool& serverPool, u32 position) const
+    {
+        f32 weight = serverPool.weights[position];
+        if (weight >= 1.0f)
+            return true;
+
+        const ServerEntry& serverEntry = serverPool.entries[position];
+        serverEntry.slowStartCredit += weight;
+        if (serverEntry.slowStartCredit < 1.0f)
+            return false;
+
+        serverEntry.slowStartCredit -= 1.0f;
+        return true;
+    }
+
+    // Called at the start of every tick, the backend systems read it once the packets of the tick have been handled
+    inline void SetTime(f32 now) { currentTime = now; }
+    inline f32 GetTime() const { return currentTime; }
+
+    // Every policy which hands out a server records it here
+    inline void RecordAssignment(const ServerEntry& serverEntry)
+    {
+        BackendStats& backendStats = registry->get<BackendStats>(serverEntry.backend);
+        backendStats.totalAssignments++;
+        backendStats.windowAssignments++;
+        backendStats.lastAssignedAt = currentTime;
+    }
+    inline const BackendStats& GetStats(const ServerEntry& serverEntry) const { return registry->get<BackendStats>(serverEntry.backend); }
+    inline const BackendHealth& GetHealth(const ServerEntry& serverEntry) const { return registry->get<BackendHealth>(serverEntry.backend); }
+
+    // Requesters report servers they failed to reach by the address they were given, address is in network byte order
+    inline bool ReportFailure(u32 address, u16 port)
+    {
+        const ServerEntry* serverEntry = FindByAddress(address, port);
+        if (!serverEntry)
+            return false;
+
+        BackendHealth& backendHealth = registry->get<BackendHealth>(serverEntry->backend);
+        backendHealth.failureReports++;
+        backendHealth.windowFailures++;
+        return true;
+    }
+
+    // Refreshes the weight of every ramping server, run by BackendSelectionSystem once per tick
+    inline void UpdateSlowStart()
+    {
+        UpdateSlowStart(authServers);
+        UpdateSlowStart(loadBalancers);
+        UpdateSlowStart(regionServers);
+        UpdateSlowStart(chatServers);
+        for (auto& realm : realmServersMap)
+            UpdateSlowStart(realm.second);
+        for (auto& realm : worldServersMap)
+            UpdateSlowStart(realm.second);
+        for (auto& realm : instanceServersMap)
+            UpdateSlowStart(realm.second);
+    }
+
+    template <typename Func>
+    inline void ForEachPool(Func&& func) const
+    {
+        func(AddressType::AUTH, 0, authServers);
+        func(AddressType::LOADBALANCE, 0, loadBalancers);
+        func(AddressType::REGION, 0, regionServers);
+        func(AddressType::CHAT, 0, chatServers);
+        for (auto& realm : realmServersMap)
+            func(AddressType::REALM, realm.first, realm.second);
+        for (auto& realm : worldServersMap)
+            func(AddressType::WORLD, realm.first, realm.second);
+        for (auto& realm : instanceServersMap)
+            func(AddressType::INSTANCE, realm.first, realm.second);
+    }
+
+    f32 slowStartWindow = 30.0f; // Seconds, 0 disables slow start
+    f32 slowStartMinWeight = 0.1f;
+
+    // A backend which gets failureThreshold failure reports within failureWindow is left out of selection for unhealthyCooldown, 0 disables it
+    u32 failureThreshold = 10;
+    f32 failureWindow = 10.0f;
+    f32 unhealthyCooldown = 30.0f;
+
+    static constexpr f32 STATS_WINDOW = 1.0f;
+    f32 statsWindowStart = 0.0f; // Owned by BackendStatsSystem
+
+    // A hot restart hands the servers to the next process, their drain state and placement reservations go along
+    // Health, stats and slow start are rebuilt by the new process. The snapshot is only read by the build that wrote it
+    inline void WriteSnapshot(std::vector<u8>& snapshot) const
+    {
+        u32 numServers = 0;
+        ForEachPool([&numServers](AddressType, u8, const ServerPool& serverPool)
         {
-            size_t numOf = regionServers.size();
-            if (numOf == 0)
-                return false;
+            numServers += serverPool.Size();
+        });
 
-            serverInformation = regionServers[regionIndex++];
+        snapshot.resize(sizeof(u32) + static_cast<size_t>(numServers) * SNAPSHOT_ENTRY_SIZE);
+        u8* data = snapshot.data();
+        std::memcpy(data, &numServers, sizeof(u32));
+        data += sizeof(u32);
 
-            // Wrap index around if needed
-            if (regionIndex == numOf)
-                regionIndex = 0;
-        }
-        else if constexpr (type == AddressType::CHAT)
+        ForEachPool([&data](AddressType, u8, const ServerPool& serverPool)
         {
-            size_t numOf = chatServers.size();
-            if (numOf == 0)
-                return false;
+            for (u32 i = 0; i < serverPool.Size(); i++)
+            {
+                u8 flags = serverPool.flags[i] & ServerPool::FLAG_DRAINING;
+                std::memcpy(data, &serverPool.entries[i].info, sizeof(ServerInformation));
+                std::memcpy(data + sizeof(ServerInformation), &serverPool.loads[i], sizeof(u32));
+                std::memcpy(data + sizeof(ServerInformation) + sizeof(u32), &flags, sizeof(u8));
+                data += SNAPSHOT_ENTRY_SIZE;
+            }
+        });
+    }
+    // Replaces every server we know, returns false and leaves the pools empty if the snapshot is malformed
+    inline bool ReadSnapshot(const std::vector<u8>& snapshot)
+    {
+        Clear();
 
-            serverInformation = chatServers[chatIndex++];
+        u32 numServers = 0;
+        if (snapshot.size() < sizeof(u32))
+            return false;
 
-            // Wrap index around if needed
-            if (chatIndex == numOf)
-                chatIndex = 0;
-        }
-        else if constexpr (type == AddressType::REALM)
+        std::memcpy(&numServers, snapshot.data(), sizeof(u32));
+        if (snapshot.size() != sizeof(u32) + static_cast<size_t>(numServers) * SNAPSHOT_ENTRY_SIZE)
+            return false;
+
+        const u8* data = snapshot.data() + sizeof(u32);
+        for (u32 i = 0; i < numServers; i++, data += SNAPSHOT_ENTRY_SIZE)
         {
-            size_t numOf = realmServersMap[realmId].size();
-            if (numOf == 0)
+            ServerInformation info;
+            u32 load = 0;
+            u8 flags = 0;
+            std::memcpy(&info, data, sizeof(ServerInformation));
+            std::memcpy(&load, data + sizeof(ServerInformation), sizeof(u32));
+            std::memcpy(&flags, data + sizeof(ServerInformation) + sizeof(u32), sizeof(u8));
+
+            if (info.type <= AddressType::INVALID || info.type >= AddressType::COUNT)
+            {
+                Clear();
                 return false;
+            }
 
-            u8& index = realmServersIndex[realmId];
-            serverInformation = realmServersMap[realmId][index++];
+            Add(info);
 
-            // Wrap index around if needed
-            if (index == numOf)
-                index = 0;
+            ServerPool* serverPool = GetPool(info.type, info.realmId);
+            u32 position = serverPool->Find(info.entity);
+            serverPool->loads[position] = load;
+            SetFlagAt(*serverPool, position, ServerPool::FLAG_DRAINING, (flags & ServerPool::FLAG_DRAINING) != 0);
         }
-        else if constexpr (type == AddressType::WORLD)
+
+        return true;
+    }
+
+    // Bumped whenever a server is added, updated or removed, lets views over the pools know when to rebuild
+    inline u32 GetVersion() const { return version; }
+
+    // Returns nullptr if no server matched, a draining server stays known but is skipped by every selection
+    inline const ServerEntry* SetDraining(AddressType type, entt::entity entity, u8 realmId, bool isDraining)
+    {
+        ServerPool* serverPool = GetPool(type, realmId);
+        if (!serverPool)
+            return nullptr;
+
+        return SetFlagAt(*serverPool, serverPool->Find(entity), ServerPool::FLAG_DRAINING, isDraining);
+    }
+    // Console operators know servers by address. Address is in network byte order
+    inline const ServerEntry* SetDraining(u32 address, u16 port, bool isDraining)
+    {
+        const ServerEntry* match = FindByAddress(address, port);
+        if (!match)
+            return nullptr;
+
+        ServerPool* serverPool = GetPool(match->info.type, match->info.realmId);
+        return SetFlagAt(*serverPool, serverPool->Find(match->info.entity), ServerPool::FLAG_DRAINING, isDraining);
+    }
+    // Set by BackendHealthSystem, an unhealthy server is skipped by every selection like a draining one
+    inline const ServerEntry* SetHealthy(const BackendLocation& location, bool isHealthy)
+    {
+        ServerPool* serverPool = GetPool(location.type, location.realmId);
+        if (!serverPool)
+            return nullptr;
+
+        return SetFlagAt(*serverPool, serverPool->Find(location.serverEntity), ServerPool::FLAG_UNHEALTHY, !isHealthy);
+    }
+
+private:
+    static constexpr size_t SNAPSHOT_ENTRY_SIZE = sizeof(ServerInformation) + sizeof(u32) + sizeof(u8); // info, load, flags
+
+    inline static u64 GetAddressKey(u32 address, u16 port)
+    {
+        return (static_cast<u64>(address) << 16) | port;
+    }
+    // Only drops the address if it still points at this server, two entities may briefly share an address while one replaces the other
+    inline void RemoveAddress(const ServerInformation& info)
+    {
+        auto itr = addressIndex.find(GetAddressKey(info.address, info.port));
+        if (itr != addressIndex.end() && itr->second.serverEntity == info.entity)
+            addressIndex.erase(itr);
+    }
+    inline const ServerEntry* SetFlagAt(ServerPool& serverPool, u32 position, u8 flag, bool isSet)
+    {
+        if (position == ServerPool::INVALID_POSITION)
+            return nullptr;
+
+        if (isSet)
+            serverPool.flags[position] |= flag;
+        else
+            serverPool.flags[position] &= ~flag;
+
+        version++;
+        return &serverPool.entries[position];
+    }
+    // Refreshes the weight of every ramping server, pools without one are skipped
+    inline void UpdateSlowStart(ServerPool& serverPool)
+    {
+        if (serverPool.numRamping == 0)
+            return;
+
+        u32 numServers = serverPool.Size();
+        for (u32 i = 0; i < numServers; i++)
         {
-            size_t numOf = worldServersMap[realmId].size();
-            if (numOf == 0)
-                return false;
+            if (!(serverPool.flags[i] & ServerPool::FLAG_RAMPING))
+                continue;
 
-            u8& index = worldServersIndex[realmId];
-            serverInformation = worldServersMap[realmId][index++];
+            f32 progress = (currentTime - serverPool.entries[i].addedAt) / slowStartWindow;
+            if (progress >= 1.0f)
+            {
+                serverPool.weights[i] = 1.0f;
+                serverPool.flags[i] &= ~ServerPool::FLAG_RAMPING;
+                serverPool.numRamping--;
+                continue;
+            }
 
-            // Wrap index around if needed
-            if (index == numOf)
-                index = 0;
+            serverPool.weights[i] = slowStartMinWeight + (1.0f - slowStartMinWeight) * std::max(progress, 0.0f);
         }
-        else if constexpr (type == AddressType::INSTANCE)
+    }
+    // Takes the server at position out of the pool, its backend and address are up to the caller
+    inline void ErasePosition(ServerPool& serverPool, u32 position)
+    {
+        serverPool.positions.erase(serverPool.entries[position].info.entity);
+
+        if (serverPool.flags[position] & ServerPool::FLAG_RAMPING)
+            serverPool.numRamping--;
+
+        // Swap the last server into the hole, erasing from the middle of a pool of ten thousand servers would shift all of them
+        u32 last = serverPool.Size() - 1;
+        if (position != last)
         {
-            size_t numOf = instanceServersMap[realmId].size();
-            if (numOf == 0)
-                return false;
+            serverPool.weights[position] = serverPool.weights[last];
+            serverPool.loads[position] = serverPool.loads[last];
+            serverPool.flags[position] = serverPool.flags[last];
+            serverPool.entries[position] = std::move(serverPool.entries[last]);
+            serverPool.positions[serverPool.entries[position].info.entity] = position;
+        }
 
-            u8& index = instanceServersIndex[realmId];
-            serverInformation = instanceServersMap[realmId][index++];
+        serverPool.weights.pop_back();
+        serverPool.loads.pop_back();
+        serverPool.flags.pop_back();
+        serverPool.entries.pop_back();
+    }
+    inline entt::entity CreateBackend(AddressType type, const ServerInformation& info)
+    {
+        entt::entity backend = registry->create();
+        registry->emplace<BackendLocation>(backend, type, info.realmId, info.entity);
+        registry->emplace<BackendStats>(backend);
+        registry->emplace<BackendHealth>(backend).windowStart = currentTime;
+        return backend;
+    }
+    // Round robin from the pool's cursor, skipping draining and unhealthy servers
+    inline const ServerEntry* SelectNext(ServerPool& serverPool)
+    {
+        u32& index = serverPool.cursor;
+        ServerEntry* fallback = nullptr;
 
-            // Wrap index around if needed
-            if (index == numOf)
+        u32 numOf = serverPool.Size();
+        for (u32 i = 0; i < numOf; i++)
+        {
+            // The cursor can point past the end after a server was removed
+            if (index >= numOf)
                 index = 0;
+
+            u32 position = index++;
+            if (serverPool.IsExcluded(position))
+                continue;
+
+            ServerEntry& serverEntry = serverPool.entries[position];
+            if (TakeSlowStartTurn(serverPool, position))
+            {
+                RecordAssignment(serverEntry);
+                return &serverEntry;
+            }
+
+            if (!fallback || serverEntry.slowStartCredit > fallback->slowStartCredit)
+                fallback = &serverEntry;
         }
 
-        return true;
+        // Every server is still ramping up, the one closest to its next turn takes the request
+        if (fallback)
+        {
+            fallback->slowStartCredit = 0.0f;
+            RecordAssignment(*fallback);
+        }
+
+        return fallback;
+    }
+    inline static const ServerPool* FindRealmPool(const robin_hood::unordered_map<u8, ServerPool>& map, u8 realmId)
+    {
+        auto itr = map.find(realmId);
+        return itr != map.end() ? &itr->second : nullptr;
+    }
+    inline ServerPool& GetOrCreateRealmPool(robin_hood::unordered_map<u8, ServerPool>& map, u8 realmId)
+    {
+        auto itr = map.find(realmId);
+        if (itr == map.end())
+        {
+            itr = map.emplace(realmId, ServerPool()).first;
+            itr->second.Reserve(8);
+        }
+
+        return itr->second;
     }
 
 private:
-    u8 authIndex = 0;
-    u8 loadBalanceIndex = 0;
-    u8 regionIndex = 0;
-    u8 chatIndex = 0;
-
-    std::vector<ServerInformation> authServers;
-    std::vector<ServerInformation> loadBalancers;
-    std::vector<ServerInformation> regionServers;
-    std::vector<ServerInformation> chatServers;
-
-    std::vector<u8> realmServersIndex;
-    std::vector<u8> worldServersIndex;
-    std::vector<u8> instanceServersIndex;
-
-    robin_hood::unordered_map<u8, std::vector<ServerInformation>> realmServersMap;
-    robin_hood::unordered_map<u8, std::vector<ServerInformation>> worldServersMap;
-    robin_hood::unordered_map<u8, std::vector<ServerInformation>> instanceServersMap;
-};
\ No newline at end of file
+    entt::registry* registry = nullptr;
+
+    u32 version = 0;
+    f32 currentTime = 0.0f;
+
+    ServerPool authServers;
+    ServerPool loadBalancers;
+    ServerPool regionServers;
+    ServerPool chatServers;
+
+    // Keyed by realmId
+    robin_hood::unordered_map<u8, ServerPool> realmServersMap;
+    robin_hood::unordered_map<u8, ServerPool> worldServersMap;
+    robin_hood::unordered_map<u8, ServerPool> instanceServersMap;
+
+    // Keyed by (address << 16) | port, used to find servers by the address requesters and operators know them by
+    robin_hood::unordered_map<u64, BackendLocation> addressIndex;
+
+    // Server entity to its backend entity, whose BackendLocation says which pool the server is in
+    robin_hood::unordered_map<entt::entity, entt::entity> backends;
+};
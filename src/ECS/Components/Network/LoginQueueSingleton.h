@@ -0,0 +1,215 @@
+#pragma once
+#include <NovusTypes.h>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include "LoadBalanceSingleton.h"
+#include "PlacementSingleton.h"
+#include "ConnectionSingleton.h"
+#include "AdmissionSingleton.h"
+#include "../Singletons/TimerSingleton.h"
+#include <Networking/PacketUtils.h>
+
+class NetClient;
+
+struct QueuedRequest
+{
+    std::weak_ptr<NetClient> netClient; // The queue does not keep a connection alive, its requests are dropped once it goes away
+    u64 sequence = 0;
+    u64 requesterId = 0;
+    bool hasRequesterId = false;
+    u16 sizeHint = 0;
+    TimerWheel::TimerHandle deadline = TimerWheel::INVALID_HANDLE;
+    std::vector<u8> cookie;
+};
+
+// Requests of a realm in arrival order, sequence numbers only grow so the deque stays sorted by them
+struct RealmQueue
+{
+    std::deque<QueuedRequest> requests;
+    robin_hood::unordered_map<u64, u64> requesterSequences; // requesterId -> sequence of its queued request
+
+    u32 windowReleases = 0;
+    f32 windowStart = 0.0f;
+    f32 releasesPerSecond = 0.0f; // Smoothed over release windows, drives the wait estimates
+    f32 nextUpdateAt = 0.0f;
+};
+
+/*
+    Sized INSTANCE requests which find every instance server of their realm full wait here instead of getting status 0, which only made requesters retry right away.
+    Each realm is served first in first out, once a realm has anyone waiting new requests line up behind them even if a server has room.
+    LoginQueueSystem hands out addresses as capacity frees up and sends every waiting requester its position and estimated wait every updateInterval.
+    Each request has a deadline on TimerSingleton, expiring mostly from the front of the queue as requests are served in order.
+*/
+struct LoginQueueSingleton
+{
+    static constexpr u16 UNKNOWN_ETA = 0xFFFF; // No request of the realm has been released recently to estimate from
+    static constexpr f32 RELEASE_WINDOW = 5.0f;
+
+    LoginQueueSingleton(entt::registry& inRegistry) : registry(&inRegistry) { }
+
+    inline bool IsQueueing(u8 realmId) const
+    {
+        auto itr = realms.find(realmId);
+        return itr != realms.end() && !itr->second.requests.empty();
+    }
+
+    // Requests only wait for capacity that can exist, an instance larger than a server or a realm without instance servers gets status 0 right away
+    inline bool CanWait(const LoadBalanceSingleton& loadBalanceSingleton, const PlacementSingleton& placementSingleton, u8 realmId, u16 sizeHint) const
+    {
+        if (maxQueueLength == 0 || sizeHint > placementSingleton.capacityPerServer)
+            return false;
+
+        const ServerPool* pool = loadBalanceSingleton.GetPool(AddressType::INSTANCE, realmId);
+        return pool && pool->Size() > 0;
+    }
+
+    // Returns false if the realm's queue is full, a requester which is already waiting keeps its place and deadline and only gets its cookie replaced
+    inline bool Enqueue(const std::shared_ptr<NetClient>& netClient, bool hasRequesterId, u64 requesterId, u8 realmId, u16 sizeHint, const u8* cookie, size_t cookieSize, f32 now, u32& position, u16& etaSeconds)
+    {
+        RealmQueue& realmQueue = realms[realmId];
+
+        if (hasRequesterId)
+        {
+            auto itr = realmQueue.requesterSequences.find(requesterId);
+            if (itr != realmQueue.requesterSequences.end())
+            {
+                auto request = FindRequest(realmQueue, itr->second);
+                request->netClient = netClient;
+                request->sizeHint = sizeHint;
+                request->cookie.assign(cookie, cookie + cookieSize);
+
+                position = static_cast<u32>(request - realmQueue.requests.begin()) + 1;
+                etaSeconds = GetEta(realmQueue, position);
+                return true;
+            }
+        }
+
+        if (realmQueue.requests.size() >= maxQueueLength)
+        {
+            numRejected++;
+            return false;
+        }
+
+        if (realmQueue.requests.empty())
+        {
+            realmQueue.windowStart = now;
+            realmQueue.nextUpdateAt = now + updateInterval;
+        }
+
+        QueuedRequest& request = realmQueue.requests.emplace_back();
+        request.netClient = netClient;
+        request.sequence = nextSequence++;
+        request.requesterId = requesterId;
+        request.hasRequesterId = hasRequesterId;
+        request.sizeHint = sizeHint;
+        request.cookie.assign(cookie, cookie + cookieSize);
+
+        // Sequence numbers would need 2^56 requests to spill into the realm id
+        TimerSingleton& timerSingleton = registry->ctx<TimerSingleton>();
+        request.deadline = timerSingleton.wheel.Schedule(TimerSingleton::ToTicks(maxWaitTime), OnDeadline, this, (request.sequence << 8) | realmId);
+
+        if (hasRequesterId)
+            realmQueue.requesterSequences[requesterId] = request.sequence;
+
+        numWaiting++;
+        numQueued++;
+
+        position = static_cast<u32>(realmQueue.requests.size());
+        etaSeconds = GetEta(realmQueue, position);
+        return true;
+    }
+
+    inline void PopFront(RealmQueue& realmQueue)
+    {
+        Forget(realmQueue, realmQueue.requests.front());
+        realmQueue.requests.pop_front();
+    }
+    // Everything but taking the request out of the deque, which is left to the caller
+    inline void Forget(RealmQueue& realmQueue, QueuedRequest& request)
+    {
+        registry->ctx<TimerSingleton>().wheel.Cancel(request.deadline);
+        if (request.hasRequesterId)
+            realmQueue.requesterSequences.erase(request.requesterId);
+
+        numWaiting--;
+    }
+
+    // A request which is still waiting when its deadline fires is answered with AddressStatus::TIMED_OUT
+    inline static void OnDeadline(void* context, u64 data, u64 /*now*/)
+    {
+        static_cast<LoginQueueSingleton*>(context)->Expire(static_cast<u8>(data & 0xFF), data >> 8);
+    }
+
+    // Before a hot restart hands the connection over, the requesters ask the new process again
+    inline void ExpireAll()
+    {
+        for (auto& realm : realms)
+        {
+            while (!realm.second.requests.empty())
+                Expire(realm.first, realm.second.requests.front().sequence);
+        }
+    }
+
+    inline static u16 GetEta(const RealmQueue& realmQueue, u32 position)
+    {
+        if (realmQueue.releasesPerSecond <= 0.0f)
+            return UNKNOWN_ETA;
+
+        f32 eta = std::ceil(position / realmQueue.releasesPerSecond);
+        return static_cast<u16>(std::min(eta, static_cast<f32>(UNKNOWN_ETA - 1)));
+    }
+
+    u32 maxQueueLength = 10000; // Per realm, 0 disables the queue
+    f32 maxWaitTime = 600.0f; // Seconds, a request still waiting after this gets AddressStatus::TIMED_OUT
+    f32 updateInterval = 5.0f; // Seconds between position updates
+    u16 queueFullRetryMs = 30000; // Sent with BUSY when a realm's queue is full
+
+    u64 nextSequence = 0;
+    u32 numWaiting = 0;
+
+    u64 numQueued = 0;
+    u64 numReleased = 0;
+    u64 numExpired = 0;
+    u64 numRejected = 0;
+
+    robin_hood::unordered_map<u8, RealmQueue> realms;
+
+private:
+    inline void Expire(u8 realmId, u64 sequence)
+    {
+        auto realmItr = realms.find(realmId);
+        if (realmItr == realms.end())
+            return;
+
+        RealmQueue& realmQueue = realmItr->second;
+        auto request = FindRequest(realmQueue, sequence);
+        if (request == realmQueue.requests.end() || request->sequence != sequence)
+            return;
+
+        ConnectionSingleton& connectionSingleton = registry->ctx<ConnectionSingleton>();
+        std::shared_ptr<NetClient> netClient = request->netClient.lock();
+        if (netClient && connectionSingleton.GetTransport(netClient))
+        {
+            std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<512>();
+            if (PacketUtils::Write_SMSG_SEND_ADDRESS(buffer, static_cast<u8>(AddressStatus::TIMED_OUT), 0, 0, request->cookie.data(), request->cookie.size()))
+                connectionSingleton.Send(netClient, buffer);
+        }
+
+        Forget(realmQueue, *request);
+        realmQueue.requests.erase(request);
+        numExpired++;
+    }
+    inline static std::deque<QueuedRequest>::iterator FindRequest(RealmQueue& realmQueue, u64 sequence)
+    {
+        return std::lower_bound(realmQueue.requests.begin(), realmQueue.requests.end(), sequence, [](const QueuedRequest& request, u64 value)
+        {
+            return request.sequence < value;
+        });
+    }
+
+private:
+    entt::registry* registry;
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <vector>
+#include <algorithm>
+#include "LoadBalanceSingleton.h"
+
+enum class PlacementStrategy : u8
+{
+    BEST_FIT, // The server with the least capacity left that still fits, packs instances tightly
+    WORST_FIT // The server with the most capacity left, spreads instances out
+};
+
+/*
+    Capacity aware placement for INSTANCE requests which carry a size hint.
+    Every instance server has the same capacity, placing an instance reserves its size on the chosen server until MSG_INSTANCE_COMPLETE releases it.
+    Requests without a size hint keep using the regular rotation.
+*/
+struct PlacementSingleton
+{
+    // Set on the AddressType byte of a request when a u16 instance size hint follows it (after the requester id if both are present)
+    static constexpr u8 INSTANCE_SIZE_FLAG = 0x40;
+
+    // Returns nullptr if no instance server in the realm has room for the instance
+    inline const ServerEntry* Place(LoadBalanceSingleton& loadBalanceSingleton, u8 realmId, u16 size)
+    {
+        ServerPool* pool = loadBalanceSingleton.GetPool(AddressType::INSTANCE, realmId);
+        if (!pool)
+            return nullptr;
+
+        u32 position = FindFit(*pool, size, true);
+
+        // A lone server that is still ramping up would otherwise refuse anything above a fraction of its capacity, room it really has beats rejecting the request
+        if (position == ServerPool::INVALID_POSITION && pool->numRamping > 0)
+            position = FindFit(*pool, size, false);
+
+        if (position == ServerPool::INVALID_POSITION)
+        {
+            numRejected++;
+            return nullptr;
+        }
+
+        pool->loads[position] += size;
+
+        const ServerEntry& chosen = pool->entries[position];
+        loadBalanceSingleton.RecordAssignment(chosen);
+        numPlaced++;
+        return &chosen;
+    }
+
+    // The completion identifies the server the same way the requester got it, by address and port
+    inline bool Release(LoadBalanceSingleton& loadBalanceSingleton, u8 realmId, u32 address, u16 port, u16 size)
+    {
+        const ServerEntry* entry = loadBalanceSingleton.FindByAddress(address, port);
+        if (!entry || entry->info.type != AddressType::INSTANCE || entry->info.realmId != realmId)
+            return false;
+
+        ServerPool* pool = loadBalanceSingleton.GetPool(AddressType::INSTANCE, realmId);
+        u32& load = pool->loads[pool->Find(entry->info.entity)];
+        if (load == 0)
+            return false;
+
+        load -= std::min(load, static_cast<u32>(size));
+        return true;
+    }
+
+    // Reservations live in the server's pool, a server that is removed and comes back starts empty
+    inline u32 GetReserved(const LoadBalanceSingleton& loadBalanceSingleton, const ServerEntry& serverEntry) const
+    {
+        const ServerPool* pool = loadBalanceSingleton.GetPool(serverEntry.info.type, serverEntry.info.realmId);
+        if (!pool)
+            return 0;
+
+        u32 position = pool->Find(serverEntry.info.entity);
+        return position != ServerPool::INVALID_POSITION ? pool->loads[position] : 0;
+    }
+
+    PlacementStrategy strategy = PlacementStrategy::BEST_FIT;
+    u32 capacityPerServer = 100;
+
+    u64 numPlaced = 0;
+    u64 numRejected = 0;
+
+    static constexpr u32 NO_FIT = ~0u;
+
+    // Lower is better for both strategies, servers which are draining, unhealthy or lack room get NO_FIT
+    // Static so the ServerPool bench scans with the same key as placement
+    inline static u32 GetFitKey(u32 capacityPerServer, f32 weight, u32 load, u8 flags, u32 size, bool isBestFit)
+    {
+        // A server in its slow start window only offers part of its capacity, otherwise worst fit would send every instance to it
+        u32 capacity = static_cast<u32>(capacityPerServer * weight);
+        u32 needed = load + size;
+        u32 remaining = capacity - needed;
+
+        u32 key = isBestFit ? remaining : NO_FIT - 1 - remaining;
+
+        // Masked instead of branched on, a select feeding the min reduction keeps the compiler from vectorizing it
+        u32 isExcluded = std::min<u32>(flags & ServerPool::FLAG_EXCLUDED, 1);
+        u32 isFull = needed > capacity;
+        return key | (0u - (isExcluded | isFull));
+    }
+    // Two passes over the pool's arrays instead of one loop carrying the chosen server
+    // The first is a branch free min reduction the compiler can vectorize, the second stops at the first server matching it
+    // Without isRampLimited every server offers its full capacity, slow start or not
+    inline u32 FindFit(const ServerPool& pool, u16 size, bool isRampLimited) const
+    {
+        const f32* weights = pool.weights.data();
+        const u32* loads = pool.loads.data();
+        const u8* flags = pool.flags.data();
+        u32 numServers = pool.Size();
+        bool isBestFit = strategy == PlacementStrategy::BEST_FIT;
+
+        u32 bestKey = NO_FIT;
+        for (u32 i = 0; i < numServers; i++)
+            bestKey = std::min(bestKey, GetFitKey(capacityPerServer, isRampLimited ? weights[i] : 1.0f, loads[i], flags[i], size, isBestFit));
+
+        if (bestKey == NO_FIT)
+            return ServerPool::INVALID_POSITION;
+
+        for (u32 i = 0; i < numServers; i++)
+        {
+            if (GetFitKey(capacityPerServer, isRampLimited ? weights[i] : 1.0f, loads[i], flags[i], size, isBestFit) == bestKey)
+                return i;
+        }
+
+        return ServerPool::INVALID_POSITION;
+    }
+};
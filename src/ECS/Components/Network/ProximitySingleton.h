@@ -0,0 +1,157 @@
+#pragma once
+#include <NovusTypes.h>
+#include <vector>
+#include "LoadBalanceSingleton.h"
+#include "../../../Utils/PrefixTable.h"
+
+/*
+    Optional proximity policy for address requests, enabled once a prefix table is loaded.
+    Servers in the requester's zone are preferred, we only go cross zone when the zone has no server of the requested type or its servers are overloaded.
+    A zone is overloaded when its servers took more than overloadFactor times the pool's per server average of selections in the current window.
+*/
+struct ProximitySingleton
+{
+    static constexpr f32 LOAD_WINDOW = 1.0f;
+    // Set on the AddressType byte of a request when a u32 network order requester address follows it (after the realm id)
+    // Requests relayed by an upstream carry it, without it the zone is taken from the connection's own address
+    static constexpr u8 REQUESTER_ADDRESS_FLAG = 0x10;
+
+    struct ZoneState
+    {
+        u32 cursor = 0;
+        u32 selections = 0;
+        std::vector<u32> servers; // Positions in the pool, a zone's scan never touches the rest of a large pool
+    };
+
+    // Zones of a pool's servers, rebuilt when LoadBalanceSingleton's version changes
+    struct PoolState
+    {
+        u32 version = ~0u;
+        u32 selections = 0;
+        robin_hood::unordered_map<u16, ZoneState> zones;
+    };
+
+    inline bool IsEnabled() const { return !prefixTable.IsEmpty(); }
+
+    inline bool Load(const std::string& path)
+    {
+        if (!prefixTable.Load(path))
+            return false;
+
+        // Zone ids may have changed, rebuild every pool on its next use
+        pools.clear();
+        return true;
+    }
+
+    inline u16 GetZone(u32 networkOrderAddress) const
+    {
+        return prefixTable.LookupNetworkOrder(networkOrderAddress);
+    }
+
+    // Returns nullptr if the caller should fall back to the regular rotation
+    inline const ServerEntry* Select(LoadBalanceSingleton& loadBalanceSingleton, AddressType type, u8 realmId, u16 requesterZone, f32 now)
+    {
+        if (requesterZone == PrefixTable::INVALID_ZONE)
+            return nullptr;
+
+        const ServerPool* pool = loadBalanceSingleton.GetPool(type, realmId);
+        if (!pool || pool->Size() == 0)
+            return nullptr;
+
+        if (now - windowStart >= LOAD_WINDOW)
+        {
+            windowStart = now;
+            for (auto& poolItr : pools)
+            {
+                poolItr.second.selections = 0;
+                for (auto& zoneItr : poolItr.second.zones)
+                    zoneItr.second.selections = 0;
+            }
+        }
+
+        PoolState& poolState = pools[(static_cast<u16>(type) << 8) | realmId];
+        if (poolState.version != loadBalanceSingleton.GetVersion())
+            Rebuild(poolState, *pool, loadBalanceSingleton.GetVersion());
+
+        poolState.selections++;
+
+        auto zoneItr = poolState.zones.find(requesterZone);
+        if (zoneItr == poolState.zones.end())
+        {
+            numCrossZone++;
+            return nullptr;
+        }
+
+        ZoneState& zoneState = zoneItr->second;
+        f32 zoneShare = static_cast<f32>(zoneState.selections) / zoneState.servers.size();
+        f32 poolAverage = static_cast<f32>(poolState.selections) / pool->Size();
+        if (zoneShare > poolAverage * overloadFactor)
+        {
+            numCrossZone++;
+            return nullptr;
+        }
+
+        // Servers in their slow start window only take their turn once their credit adds up, if every local server is ramping the one closest to its turn is used
+        const ServerEntry* fallback = nullptr;
+        u32 fallbackIndex = 0;
+
+        u32 numServers = static_cast<u32>(zoneState.servers.size());
+        for (u32 i = 0; i < numServers; i++)
+        {
+            u32 index = (zoneState.cursor + i) % numServers;
+            u32 position = zoneState.servers[index];
+            const ServerEntry& serverEntry = pool->entries[position];
+
+            if (loadBalanceSingleton.TakeSlowStartTurn(*pool, position))
+                return SelectLocal(loadBalanceSingleton, zoneState, serverEntry, index);
+
+            if (!fallback || serverEntry.slowStartCredit > fallback->slowStartCredit)
+            {
+                fallback = &serverEntry;
+                fallbackIndex = index;
+            }
+        }
+
+        if (!fallback)
+            return nullptr;
+
+        fallback->slowStartCredit = 0.0f;
+        return SelectLocal(loadBalanceSingleton, zoneState, *fallback, fallbackIndex);
+    }
+
+    PrefixTable prefixTable;
+    f32 overloadFactor = 2.0f;
+
+    f32 windowStart = 0.0f;
+    robin_hood::unordered_map<u16, PoolState> pools; // Keyed by (AddressType << 8) | realmId
+
+    u64 numLocal = 0;
+    u64 numCrossZone = 0;
+
+private:
+    inline const ServerEntry* SelectLocal(LoadBalanceSingleton& loadBalanceSingleton, ZoneState& zoneState, const ServerEntry& serverEntry, u32 index)
+    {
+        zoneState.cursor = index + 1;
+        zoneState.selections++;
+        numLocal++;
+
+        loadBalanceSingleton.RecordAssignment(serverEntry);
+        return &serverEntry;
+    }
+    inline void Rebuild(PoolState& poolState, const ServerPool& pool, u32 version)
+    {
+        poolState.version = version;
+        poolState.zones.clear();
+
+        // Draining and unhealthy servers are left out of their zone entirely
+        for (u32 i = 0; i < pool.Size(); i++)
+        {
+            if (pool.IsExcluded(i))
+                continue;
+
+            u16 zone = GetZone(pool.entries[i].info.address);
+            if (zone != PrefixTable::INVALID_ZONE)
+                poolState.zones[zone].servers.push_back(i);
+        }
+    }
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Utils/ByteBuffer.h>
+#include <Networking/NetClient.h>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <entity/registry.hpp>
+#include "ConnectionSingleton.h"
+#include "../../../Network/Transport/MemoryTransport.h"
+
+/*
+    Capture file layout: CAPTURE_MAGIC followed by records of (u64 timestamp in microseconds since capture start, u32 size, u8[size] framed packet)
+    Every record holds exactly one packet including its header, so a capture can be fed back through the regular framing.
+*/
+struct TrafficCaptureSingleton
+{
+    static constexpr char CAPTURE_MAGIC[8] = { 'N', 'C', 'L', 'B', 'C', 'A', 'P', '1' };
+    static constexpr size_t REPLAY_BUFFER_SIZE = 65536;
+
+    using Clock = std::chrono::steady_clock;
+
+    inline bool StartCapture(const std::string& path)
+    {
+        StopCapture();
+
+        captureStream.open(path, std::ios::binary | std::ios::trunc);
+        if (!captureStream.is_open())
+            return false;
+
+        captureStream.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+        captureStart = Clock::now();
+        capturedPackets = 0;
+        return true;
+    }
+    inline void StopCapture()
+    {
+        if (captureStream.is_open())
+            captureStream.close();
+    }
+    inline bool IsCapturing() const { return captureStream.is_open(); }
+
+    inline void Write(const u8* data, size_t size)
+    {
+        u64 timestamp = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - captureStart).count();
+        u32 recordSize = static_cast<u32>(size);
+
+        captureStream.write(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp));
+        captureStream.write(reinterpret_cast<const char*>(&recordSize), sizeof(recordSize));
+        captureStream.write(reinterpret_cast<const char*>(data), size);
+        capturedPackets++;
+    }
+
+    inline bool StartReplay(const std::string& path, bool fast)
+    {
+        StopReplay();
+
+        replayStream.open(path, std::ios::binary);
+        if (!replayStream.is_open())
+            return false;
+
+        char magic[sizeof(CAPTURE_MAGIC)];
+        if (!replayStream.read(magic, sizeof(magic)) || std::memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) != 0)
+        {
+            replayStream.close();
+            return false;
+        }
+
+        replayStorage.resize(REPLAY_BUFFER_SIZE);
+        replayBuffer = std::make_shared<Bytebuffer>(replayStorage.data(), replayStorage.size());
+
+        // Replayed packets are dispatched against a transport of their own, responses go nowhere
+        replayTransport = std::make_shared<MemoryTransport>(true);
+        replayTransport->GetClient()->SetConnectionStatus(ConnectionStatus::CONNECTED);
+
+        replayFast = fast;
+        replayStart = Clock::now();
+        replayedPackets = 0;
+        replayedBytes = 0;
+        hasPendingRecord = false;
+        return true;
+    }
+    inline void StopReplay()
+    {
+        if (replayStream.is_open())
+            replayStream.close();
+
+        replayRegistry = nullptr;
+        replayTransport = nullptr;
+        replayBuffer = nullptr;
+    }
+    inline bool IsReplaying() const { return replayStream.is_open(); }
+
+    // Capture
+    std::ofstream captureStream;
+    Clock::time_point captureStart;
+    u64 capturedPackets = 0;
+
+    // Replay
+    std::ifstream replayStream;
+    std::vector<u8> replayStorage;
+    std::shared_ptr<Bytebuffer> replayBuffer = nullptr;
+    std::shared_ptr<MemoryTransport> replayTransport = nullptr;
+    std::unique_ptr<entt::registry> replayRegistry = nullptr; // Scratch state the handlers run against, set up by TrafficReplaySystem::Start
+    PacketLanes replayPacketLanes;
+    Clock::time_point replayStart;
+    bool replayFast = false;
+
+    // The next record, read ahead so we can wait for its timestamp when replaying at recorded pace
+    bool hasPendingRecord = false;
+    u64 pendingTimestamp = 0;
+    std::vector<u8> pendingRecord;
+
+    u64 replayedPackets = 0;
+    u64 replayedBytes = 0;
+};
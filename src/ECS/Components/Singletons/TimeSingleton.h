@@ -6,4 +6,5 @@ struct TimeSingleton
     f32 deltaTime;
     f32 lifeTimeInS;
     f32 lifeTimeInMS;
-};
\ No newline at end of file
+    u64 lifeTimeInWholeMS; // Exact where the f32 fields lose whole milliseconds after a few hours, drives TimerSingleton
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <NovusTypes.h>
+#include <cmath>
+#include "../../../Utils/TimerWheel.h"
+
+// Deadlines and periodic jobs of the engine, TimerSystem advances the wheel to TimeSingleton::lifeTimeInWholeMS at the end of every tick
+struct TimerSingleton
+{
+    static constexpr u32 RESERVED_TIMERS = 65536;
+
+    TimerSingleton()
+    {
+        wheel.Reserve(RESERVED_TIMERS);
+    }
+
+    // The wheel ticks in milliseconds
+    inline static u64 ToTicks(f32 seconds) { return static_cast<u64>(std::ceil(seconds * 1000.0f)); }
+    inline static f32 ToSeconds(u64 ticks) { return ticks / 1000.0f; }
+
+    TimerWheel wheel;
+};
@@ -0,0 +1,88 @@
+#include "BackendSystems.h"
+#include <entt.hpp>
+#include "../../Components/Network/LoadBalanceSingleton.h"
+#include "../../Components/Network/BackendComponents.h"
+#include "../../../Utils/AsyncLogger.h"
+#include <tracy/Tracy.hpp>
+
+void BackendStatsSystem::Update(entt::registry& registry)
+{
+    LoadBalanceSingleton& loadBalanceSingleton = registry.ctx<LoadBalanceSingleton>();
+
+    f32 now = loadBalanceSingleton.GetTime();
+    f32 elapsed = now - loadBalanceSingleton.statsWindowStart;
+    if (elapsed < LoadBalanceSingleton::STATS_WINDOW)
+        return;
+
+    ZoneScopedNC("BackendStatsSystem::Update", tracy::Color::Blue)
+
+    auto view = registry.view<BackendStats>();
+    view.each([elapsed](BackendStats& backendStats)
+    {
+        backendStats.assignmentsPerSecond = backendStats.windowAssignments / elapsed;
+        backendStats.windowAssignments = 0;
+    });
+
+    loadBalanceSingleton.statsWindowStart = now;
+}
+
+void BackendHealthSystem::Update(entt::registry& registry)
+{
+    LoadBalanceSingleton& loadBalanceSingleton = registry.ctx<LoadBalanceSingleton>();
+    if (loadBalanceSingleton.failureThreshold == 0)
+        return;
+
+    ZoneScopedNC("BackendHealthSystem::Update", tracy::Color::Blue)
+
+    f32 now = loadBalanceSingleton.GetTime();
+    u32 numUnhealthy = 0;
+
+    auto view = registry.view<BackendLocation, BackendHealth>();
+    view.each([&](const BackendLocation& location, BackendHealth& backendHealth)
+    {
+        if (!backendHealth.isHealthy)
+        {
+            if (now < backendHealth.unhealthyUntil)
+            {
+                numUnhealthy++;
+                return;
+            }
+
+            backendHealth.isHealthy = true;
+            backendHealth.windowFailures = 0;
+            backendHealth.windowStart = now;
+            loadBalanceSingleton.SetHealthy(location, true);
+
+#ifdef NC_Debug
+            AsyncLogger::Print("[LoadBalancer]: Server (%u) finished its unhealthy cooldown", static_cast<u32>(location.serverEntity));
+#endif // NC_Debug
+            return;
+        }
+
+        if (backendHealth.windowFailures >= loadBalanceSingleton.failureThreshold)
+        {
+            backendHealth.isHealthy = false;
+            backendHealth.unhealthyUntil = now + loadBalanceSingleton.unhealthyCooldown;
+            loadBalanceSingleton.SetHealthy(location, false);
+            numUnhealthy++;
+
+            AsyncLogger::PrintWarning("[LoadBalancer]: Server (%u) got %u failure reports within %.0fs, leaving it out of selection for %.0fs", static_cast<u32>(location.serverEntity),
+                backendHealth.windowFailures, loadBalanceSingleton.failureWindow, loadBalanceSingleton.unhealthyCooldown);
+            return;
+        }
+
+        if (now - backendHealth.windowStart >= loadBalanceSingleton.failureWindow)
+        {
+            backendHealth.windowFailures = 0;
+            backendHealth.windowStart = now;
+        }
+    });
+
+    TracyPlot("Unhealthy Backends", static_cast<i64>(numUnhealthy));
+}
+
+void BackendSelectionSystem::Update(entt::registry& registry)
+{
+    LoadBalanceSingleton& loadBalanceSingleton = registry.ctx<LoadBalanceSingleton>();
+    loadBalanceSingleton.UpdateSlowStart();
+}
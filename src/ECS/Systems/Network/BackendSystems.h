@@ -0,0 +1,25 @@
+#pragma once
+#include <entity/fwd.hpp>
+
+// Per tick upkeep of the backends in LoadBalanceSingleton, they run after every packet of the tick has been handled
+
+class BackendStatsSystem
+{
+public:
+    // Rolls the assignment rate of every backend once per stats window
+    static void Update(entt::registry& registry);
+};
+
+class BackendHealthSystem
+{
+public:
+    // Takes backends with too many failure reports out of selection and brings them back after their cooldown
+    static void Update(entt::registry& registry);
+};
+
+class BackendSelectionSystem
+{
+public:
+    // Refreshes what selection reads from the pools which changes over time, the slow start weights
+    static void Update(entt::registry& registry);
+};
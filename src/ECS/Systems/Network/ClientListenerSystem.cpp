@@ -0,0 +1,216 @@
+#include "ClientListenerSystem.h"
+#ifndef _WIN32
+#include <entt.hpp>
+#include <Utils/ByteBuffer.h>
+#include <Networking/NetClient.h>
+#include <Networking/NetPacketHandler.h>
+#include "ConnectionSystems.h"
+#include "../../Components/Singletons/TimeSingleton.h"
+#include "../../Components/Network/ClientListenerSingleton.h"
+#include "../../Components/Network/ClientComponents.h"
+#include "../../Components/Network/ConnectionSingleton.h"
+#include "../../Components/Network/AdmissionSingleton.h"
+#include "../../../Network/Transport/PosixTransport.h"
+#include "../../../Utils/ServiceLocator.h"
+#include "../../../Utils/AsyncLogger.h"
+#include <tracy/Tracy.hpp>
+#include <unistd.h>
+
+void ClientListenerSystem::Update(entt::registry& registry)
+{
+    ClientListenerSingleton& clientListenerSingleton = registry.ctx<ClientListenerSingleton>();
+    if (!clientListenerSingleton.listener.IsListening())
+        return;
+
+    ZoneScopedNC("ClientListenerSystem::Update", tracy::Color::Blue)
+
+    ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+    f32 now = registry.ctx<TimeSingleton>().lifeTimeInS;
+
+    Accept(registry, clientListenerSingleton, connectionSingleton, now);
+
+    // One poll tells us which of the connections have anything to read, most of them are idle on any given tick
+    std::vector<pollfd>& pollFds = clientListenerSingleton.pollFds;
+    std::vector<entt::entity>& pollEntities = clientListenerSingleton.pollEntities;
+    pollFds.clear();
+    pollEntities.clear();
+
+    auto view = registry.view<ClientConnection>();
+    view.each([&pollFds, &pollEntities](entt::entity entity, ClientConnection& connection)
+    {
+        pollfd pollFd;
+        pollFd.fd = connection.transport->GetSocket();
+        pollFd.events = connection.transport->GetOutboundQueue().IsReadPaused() ? 0 : POLLIN;
+        pollFd.revents = 0;
+
+        pollFds.push_back(pollFd);
+        pollEntities.push_back(entity);
+    });
+
+    if (!pollFds.empty() && poll(pollFds.data(), static_cast<nfds_t>(pollFds.size()), 0) < 0)
+        return;
+
+    for (size_t i = 0; i < pollEntities.size(); i++)
+    {
+        entt::entity entity = pollEntities[i];
+        ClientConnection& connection = registry.get<ClientConnection>(entity);
+        PosixTransport& transport = *connection.transport;
+
+        bool isOpen = true;
+        if (pollFds[i].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            isOpen = HandleRead(clientListenerSingleton, connection, now);
+        }
+
+        if (isOpen)
+        {
+            transport.FlushOutbound();
+            ConnectionUpdateSystem::UpdateBackpressure(transport);
+
+            isOpen = transport.IsConnected();
+        }
+
+        if (isOpen && clientListenerSingleton.idleTimeout > 0.0f && now - connection.lastPacketAt >= clientListenerSingleton.idleTimeout)
+        {
+#ifdef NC_Debug
+            AsyncLogger::Print("[Network/Listener]: Closing idle client (%s, %u)", transport.GetConnectionInfo().ipAddrStr.c_str(), transport.GetConnectionInfo().port);
+#endif // NC_Debug
+            isOpen = false;
+        }
+
+        if (!isOpen)
+            Disconnect(registry, clientListenerSingleton, connectionSingleton, entity);
+    }
+
+    TracyPlot("Direct Clients", static_cast<i64>(clientListenerSingleton.numConnections));
+}
+
+void ClientListenerSystem::Accept(entt::registry& registry, ClientListenerSingleton& clientListenerSingleton, ConnectionSingleton& connectionSingleton, f32 now)
+{
+    for (u32 i = 0; i < clientListenerSingleton.maxAcceptsPerTick; i++)
+    {
+        i32 socket = clientListenerSingleton.listener.Accept();
+        if (socket < 0)
+            break;
+
+        if (clientListenerSingleton.numConnections >= clientListenerSingleton.maxConnections)
+        {
+            close(socket);
+            clientListenerSingleton.numRejected++;
+            continue;
+        }
+
+        std::shared_ptr<PosixTransport> transport = std::make_shared<PosixTransport>(ClientListenerSingleton::READ_BUFFER_SIZE);
+        transport->Adopt(socket, {});
+
+        // Direct clients don't log in, DispatchPackets only ever hands them the address request handlers
+        transport->GetClient()->SetConnectionStatus(ConnectionStatus::CONNECTED);
+        transport->SetTrustsRequesterIds(false);
+        connectionSingleton.RegisterTransport(transport.get());
+
+        entt::entity entity = registry.create();
+        ClientConnection& connection = registry.emplace<ClientConnection>(entity);
+        connection.transport = std::move(transport);
+        connection.acceptedAt = now;
+        connection.lastPacketAt = now;
+
+        clientListenerSingleton.numAccepted++;
+        clientListenerSingleton.numConnections++;
+
+#ifdef NC_Debug
+        const NetSocket::ConnectionInfo& connectionInfo = connection.transport->GetConnectionInfo();
+        AsyncLogger::Print("[Network/Listener]: Accepted client (%s, %u)", connectionInfo.ipAddrStr.c_str(), connectionInfo.port);
+#endif // NC_Debug
+    }
+}
+
+bool ClientListenerSystem::HandleRead(ClientListenerSingleton& clientListenerSingleton, ClientConnection& connection, f32 now)
+{
+    PosixTransport& transport = *connection.transport;
+    if (!transport.Read())
+        return transport.IsConnected();
+
+    Bytebuffer* buffer = transport.GetReadBuffer().get();
+
+    // Connections are handled one at a time, so the lanes are empty whenever we start and we can drain them as often as framing fills them
+    bool isLaneFull = true;
+    while (isLaneFull)
+    {
+        isLaneFull = ConnectionUpdateSystem::FramePackets(buffer, clientListenerSingleton.packetLanes, nullptr);
+
+        if (!DispatchPackets(clientListenerSingleton, connection, now))
+            return false;
+    }
+
+    // The buffer holds more than any packet the framing accepts, so a full one means it stopped at a header it refused
+    if (buffer->GetSpace() == 0)
+    {
+#ifdef NC_Debug
+        AsyncLogger::PrintWarning("[Network/Listener]: Client (%s, %u) sent a malformed packet, closing connection", transport.GetConnectionInfo().ipAddrStr.c_str(), transport.GetConnectionInfo().port);
+#endif // NC_Debug
+        return false;
+    }
+
+    return true;
+}
+
+bool ClientListenerSystem::DispatchPackets(ClientListenerSingleton& clientListenerSingleton, ClientConnection& connection, f32 now)
+{
+    NetPacketHandler* netPacketHandler = ServiceLocator::GetNetPacketHandler();
+    const std::shared_ptr<NetClient>& netClient = connection.transport->GetClient();
+    PacketLanes& packetLanes = clientListenerSingleton.packetLanes;
+
+    bool isValid = true;
+    PacketLane lane = PacketLane::CONTROL;
+    while (NetPacket* packet = packetLanes.Front(lane))
+    {
+        // The lanes are shared by every connection, whatever is left after a failure is dropped along with the connection
+        if (!isValid)
+        {
+            packetLanes.Pop(lane);
+            continue;
+        }
+
+        // Topology updates and everything else on the control lane are only taken from the upstream server
+        if (lane != PacketLane::DATA)
+        {
+#ifdef NC_Debug
+            AsyncLogger::PrintWarning("[Network/Listener]: Client (%s, %u) sent opcode %u, only address requests are accepted", connection.transport->GetConnectionInfo().ipAddrStr.c_str(), connection.transport->GetConnectionInfo().port, static_cast<u16>(packet->header.opcode));
+#endif // NC_Debug
+            isValid = false;
+            packetLanes.Pop(lane);
+            continue;
+        }
+
+        connection.numPackets++;
+        connection.lastPacketAt = now;
+
+        // The handler works on the lane slot, it is reused once popped
+        isValid = netPacketHandler->CallHandler(netClient, PacketLanes::MakeHandle(packet));
+        packetLanes.Pop(lane);
+    }
+
+    return isValid;
+}
+
+void ClientListenerSystem::Disconnect(entt::registry& registry, ClientListenerSingleton& clientListenerSingleton, ConnectionSingleton& connectionSingleton, entt::entity entity)
+{
+    ClientConnection& connection = registry.get<ClientConnection>(entity);
+    PosixTransport& transport = *connection.transport;
+
+#ifdef NC_Debug
+    const NetSocket::ConnectionInfo& connectionInfo = transport.GetConnectionInfo();
+    AsyncLogger::Print("[Network/Listener]: Client (%s, %u) disconnected after %llu packets", connectionInfo.ipAddrStr.c_str(), connectionInfo.port, static_cast<unsigned long long>(connection.numPackets));
+#endif // NC_Debug
+
+    registry.ctx<AdmissionSingleton>().RemoveConnection(transport.GetClient().get());
+    connectionSingleton.UnregisterTransport(&transport);
+    transport.Close();
+
+    // Requests queued for this client notice their connection went away once the transport and its NetClient are gone
+    registry.destroy(entity);
+
+    clientListenerSingleton.numConnections--;
+    clientListenerSingleton.numClosed++;
+}
+#endif // _WIN32
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef _WIN32
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+
+struct ClientListenerSingleton;
+struct ClientConnection;
+struct ConnectionSingleton;
+
+class ClientListenerSystem
+{
+public:
+    // Accepts new direct clients, then reads, dispatches and flushes every connection with something to do. Runs after the upstream connection's stages, it calls the same handlers
+    static void Update(entt::registry& registry);
+
+private:
+    static void Accept(entt::registry& registry, ClientListenerSingleton& clientListenerSingleton, ConnectionSingleton& connectionSingleton, f32 now);
+    // Returns false if the connection should be closed
+    static bool HandleRead(ClientListenerSingleton& clientListenerSingleton, ClientConnection& connection, f32 now);
+    static bool DispatchPackets(ClientListenerSingleton& clientListenerSingleton, ClientConnection& connection, f32 now);
+    static void Disconnect(entt::registry& registry, ClientListenerSingleton& clientListenerSingleton, ConnectionSingleton& connectionSingleton, entt::entity entity);
+};
+#endif // _WIN32
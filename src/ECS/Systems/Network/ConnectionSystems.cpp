@@ -6,57 +6,143 @@
 #include <Networking/NetPacketHandler.h>
 #include "../../Components/Network/ConnectionSingleton.h"
 #include "../../Components/Network/AuthenticationSingleton.h"
+#include "../../Components/Network/TrafficCaptureSingleton.h"
+#include "../../Components/Network/AdmissionSingleton.h"
 #include "../../../Utils/ServiceLocator.h"
+#include "../../../Utils/AsyncLogger.h"
 #include <tracy/Tracy.hpp>
+#include <thread>
 
-void ConnectionUpdateSystem::Update(entt::registry& registry)
+void ConnectionUpdateSystem::UpdateRead(entt::registry& registry)
 {
-    ZoneScopedNC("ConnectionUpdateSystem::Update", tracy::Color::Blue)
+    ZoneScopedNC("ConnectionUpdateSystem::UpdateRead", tracy::Color::Blue)
     ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+    NetTransport* transport = connectionSingleton.transport.get();
 
-    if (connectionSingleton.netClient)
+    // Whatever is left stays in the read buffer while the outbound queue is above its high watermark
+    if (transport && !connectionSingleton.isReadPaused)
     {
-        if (connectionSingleton.netClient->Read())
+        // Read reports what is buffered even once the peer closed, the last packets it sent are framed before flush handles the disconnect
+        bool hasPendingData = transport->Read();
+
+        // HandleRead stops framing when a lane is full, the dispatch stage is draining the lanes alongside us so we wait for room and frame the rest
+        // When the stages run one after the other the rest stays in the read buffer until the next tick
+        u32 numStalls = 0;
+        while (hasPendingData && HandleRead(*transport))
         {
-            HandleRead(connectionSingleton.netClient);
+            if (!connectionSingleton.isPipelined || connectionSingleton.isDispatchDone.load(std::memory_order_acquire))
+                break;
+
+            numStalls++;
+            std::this_thread::yield();
         }
 
-        if (!connectionSingleton.netClient->IsConnected())
+        TracyPlot("Control Lane Depth", static_cast<i64>(connectionSingleton.packetLanes.GetDepth(PacketLane::CONTROL)));
+        TracyPlot("Data Lane Depth", static_cast<i64>(connectionSingleton.packetLanes.GetDepth(PacketLane::DATA)));
+        TracyPlot("Read Stage Stalls", static_cast<i64>(numStalls));
+    }
+
+    connectionSingleton.isFramingDone.store(true, std::memory_order_release);
+}
+void ConnectionUpdateSystem::UpdateDispatch(entt::registry& registry)
+{
+    ZoneScopedNC("ConnectionUpdateSystem::UpdateDispatch", tracy::Color::Blue)
+    ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+    NetTransport* transport = connectionSingleton.transport.get();
+
+    if (transport)
+    {
+        const std::shared_ptr<NetClient>& netClient = transport->GetClient();
+        PacketLanes& packetLanes = connectionSingleton.packetLanes;
+
+        u64 dispatchedBefore = packetLanes.GetMetrics(PacketLane::CONTROL).numDispatched + packetLanes.GetMetrics(PacketLane::DATA).numDispatched;
+        u32 numIdleSpins = 0;
+
+        // Handle packets as the read stage frames them, once it is done a last drain picks up everything it queued
+        while (!transport->IsCloseRequested())
+        {
+            bool isFramingDone = connectionSingleton.isFramingDone.load(std::memory_order_acquire);
+
+            if (!DispatchPackets(netClient, packetLanes))
+            {
+                transport->RequestClose();
+                break;
+            }
+
+            if (isFramingDone)
+                break;
+
+            numIdleSpins++;
+            std::this_thread::yield();
+        }
+
+        u64 dispatchedAfter = packetLanes.GetMetrics(PacketLane::CONTROL).numDispatched + packetLanes.GetMetrics(PacketLane::DATA).numDispatched;
+
+        TracyPlot("Control Lane Wait (ms)", packetLanes.GetMetrics(PacketLane::CONTROL).lastWait * 1000.0);
+        TracyPlot("Data Lane Wait (ms)", packetLanes.GetMetrics(PacketLane::DATA).lastWait * 1000.0);
+        TracyPlot("Dispatched Packets", static_cast<i64>(dispatchedAfter - dispatchedBefore));
+        TracyPlot("Dispatch Stage Idle Spins", static_cast<i64>(numIdleSpins));
+    }
+
+    connectionSingleton.isDispatchDone.store(true, std::memory_order_release);
+}
+void ConnectionUpdateSystem::UpdateFlush(entt::registry& registry)
+{
+    ZoneScopedNC("ConnectionUpdateSystem::UpdateFlush", tracy::Color::Blue)
+    ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+
+    // Both stages have finished for this tick
+    connectionSingleton.isFramingDone.store(false, std::memory_order_relaxed);
+    connectionSingleton.isDispatchDone.store(false, std::memory_order_relaxed);
+
+    if (connectionSingleton.transport)
+    {
+        NetTransport* transport = connectionSingleton.transport.get();
+        transport->FlushOutbound();
+
+        if (!transport->IsConnected())
         {
             if (!connectionSingleton.didHandleDisconnect)
             {
                 connectionSingleton.didHandleDisconnect = true;
 
-                HandleDisconnect(connectionSingleton.netClient);
+                HandleDisconnect(*transport);
             }
 
             return;
         }
 
-        std::shared_ptr<NetPacket> packet = nullptr;
+        connectionSingleton.isReadPaused = UpdateBackpressure(*transport);
 
-        NetPacketHandler* netPacketHandler = ServiceLocator::GetNetPacketHandler();
-        while (connectionSingleton.packetQueue.try_dequeue(packet))
-        {
-#ifdef NC_Debug
-            DebugHandler::PrintSuccess("[Network/Socket]: CMD: %u, Size: %u", packet->header.opcode, packet->header.size);
-#endif // NC_Debug
+        TracyPlot("Outbound Queue Depth", static_cast<i64>(transport->GetOutboundQueue().GetDepth()));
+    }
+}
+bool ConnectionUpdateSystem::UpdateBackpressure(NetTransport& transport)
+{
+    OutboundQueue& outboundQueue = transport.GetOutboundQueue();
 
-            if (!netPacketHandler->CallHandler(connectionSingleton.netClient, packet))
-            {
-                connectionSingleton.netClient->Close();
-                break;
-            }
-        }
+    if (outboundQueue.UpdateWatermarks(transport.GetPendingSendBytes()))
+    {
+        bool isReadPaused = outboundQueue.IsReadPaused();
+        transport.SetReadPaused(isReadPaused);
+
+        if (isReadPaused)
+            AsyncLogger::PrintWarning("[Network/Socket]: Outbound queue above high watermark (%llu bytes), pausing reads", static_cast<unsigned long long>(outboundQueue.GetDepth()));
+        else
+            AsyncLogger::Print("[Network/Socket]: Outbound queue drained (%llu bytes), resuming reads", static_cast<unsigned long long>(outboundQueue.GetDepth()));
     }
+
+    return outboundQueue.IsReadPaused();
 }
 
-void ConnectionUpdateSystem::HandleConnect(std::shared_ptr<NetClient> netClient, bool connected)
+void ConnectionUpdateSystem::HandleConnect(NetTransport& transport, bool connected)
 {
+    const std::shared_ptr<NetClient>& netClient = transport.GetClient();
+
     if (connected)
     {
 #ifdef NC_Debug
-        const NetSocket::ConnectionInfo& connectionInfo = netClient->GetSocket()->GetConnectionInfo();
+        const NetSocket::ConnectionInfo& connectionInfo = transport.GetConnectionInfo();
         DebugHandler::PrintSuccess("[Network/Socket]: Successfully connected to (%s, %u)", connectionInfo.ipAddrStr.c_str(), connectionInfo.port);
 #endif // NC_Debug
 
@@ -85,25 +171,31 @@ void ConnectionUpdateSystem::HandleConnect(std::shared_ptr<NetClient> netClient,
         u16 writtenData = static_cast<u16>(buffer->writtenData) - size;
 
         buffer->Put<u16>(writtenData, 2);
-        netClient->Send(buffer);
+        connectionSingleton.Send(netClient, buffer);
 
         netClient->SetConnectionStatus(ConnectionStatus::AUTH_CHALLENGE);
+        transport.FlushOutbound();
     }
     else
     {
 #ifdef NC_Debug
-        const NetSocket::ConnectionInfo& connectionInfo = netClient->GetSocket()->GetConnectionInfo();
+        const NetSocket::ConnectionInfo& connectionInfo = transport.GetConnectionInfo();
         DebugHandler::PrintWarning("[Network/Socket]: Failed to connect to (%s, %u)", connectionInfo.ipAddrStr.c_str(), connectionInfo.port);
 #endif // NC_Debug
     }
 }
-void ConnectionUpdateSystem::HandleRead(std::shared_ptr<NetClient> netClient)
+bool ConnectionUpdateSystem::HandleRead(NetTransport& transport)
 {
     entt::registry* registry = ServiceLocator::GetRegistry();
     ConnectionSingleton& connectionSingleton = registry->ctx<ConnectionSingleton>();
+    TrafficCaptureSingleton& trafficCaptureSingleton = registry->ctx<TrafficCaptureSingleton>();
 
-    std::shared_ptr<Bytebuffer> buffer = netClient->GetReadBuffer();
-
+    TrafficCaptureSingleton* capture = trafficCaptureSingleton.IsCapturing() ? &trafficCaptureSingleton : nullptr;
+    return FramePackets(transport.GetReadBuffer().get(), connectionSingleton.packetLanes, capture);
+}
+bool ConnectionUpdateSystem::FramePackets(Bytebuffer* buffer, PacketLanes& packetLanes, TrafficCaptureSingleton* capture)
+{
+    bool isQueueFull = false;
     while (size_t activeSize = buffer->GetActiveSize())
     {
         // We have received a partial header and need to read more
@@ -118,7 +210,7 @@ void ConnectionUpdateSystem::HandleRead(std::shared_ptr<NetClient> netClient)
         if (header->opcode == Opcode::INVALID || header->opcode > Opcode::MAX_COUNT)
         {
 #ifdef NC_Debug
-            DebugHandler::PrintError("Received Invalid Opcode (%u) from network stream", static_cast<u16>(header->opcode));
+            AsyncLogger::PrintError("Received Invalid Opcode (%u) from network stream", static_cast<u16>(header->opcode));
 #endif // NC_Debug
             break;
         }
@@ -126,11 +218,19 @@ void ConnectionUpdateSystem::HandleRead(std::shared_ptr<NetClient> netClient)
         if (header->size > 8192)
         {
 #ifdef NC_Debug
-            DebugHandler::PrintError("Received Invalid Opcode Size (%u) from network stream", header->size);
+            AsyncLogger::PrintError("Received Invalid Opcode Size (%u) from network stream", header->size);
 #endif // NC_Debug
             break;
         }
 
+        // Leave the rest of the stream in the buffer until the queued packets have been handled, lanes keep stream order so we can't skip past this one
+        PacketLane lane = PacketLanes::Classify(header->opcode);
+        if (packetLanes.IsFull(lane))
+        {
+            isQueueFull = true;
+            break;
+        }
+
         size_t sizeWithoutHeader = activeSize - sizeof(PacketHeader);
 
         // We have received a valid header, but we have yet to receive the entire payload
@@ -140,10 +240,16 @@ void ConnectionUpdateSystem::HandleRead(std::shared_ptr<NetClient> netClient)
             break;
         }
 
+        if (capture)
+        {
+            capture->Write(buffer->GetReadPointer(), sizeof(PacketHeader) + header->size);
+        }
+
         // Skip Header
         buffer->SkipRead(sizeof(PacketHeader));
 
-        std::shared_ptr<NetPacket> packet = NetPacket::Borrow();
+        // The packet is framed straight into its lane slot, IsFull above guarantees there is one
+        NetPacket* packet = packetLanes.TryReserve(lane, header->size);
         {
             // Header
             {
@@ -154,9 +260,6 @@ void ConnectionUpdateSystem::HandleRead(std::shared_ptr<NetClient> netClient)
             {
                 if (packet->header.size)
                 {
-                    packet->payload = Bytebuffer::Borrow<8192/*NETWORK_BUFFER_SIZE*/ >();
-                    packet->payload->size = packet->header.size;
-                    packet->payload->writtenData = packet->header.size;
                     std::memcpy(packet->payload->GetDataPointer(), buffer->GetReadPointer(), packet->header.size);
 
                     // Skip Payload
@@ -164,7 +267,7 @@ void ConnectionUpdateSystem::HandleRead(std::shared_ptr<NetClient> netClient)
                 }
             }
 
-            connectionSingleton.packetQueue.enqueue(packet);
+            packetLanes.Commit(lane);
         }
     }
 
@@ -173,11 +276,37 @@ void ConnectionUpdateSystem::HandleRead(std::shared_ptr<NetClient> netClient)
     {
         buffer->Reset();
     }
+
+    return isQueueFull;
 }
-void ConnectionUpdateSystem::HandleDisconnect(std::shared_ptr<NetClient> netClient)
+bool ConnectionUpdateSystem::DispatchPackets(const std::shared_ptr<NetClient>& netClient, PacketLanes& packetLanes)
 {
+    NetPacketHandler* netPacketHandler = ServiceLocator::GetNetPacketHandler();
+
+    PacketLane lane = PacketLane::CONTROL;
+    while (NetPacket* packet = packetLanes.Front(lane))
+    {
 #ifdef NC_Debug
-    const NetSocket::ConnectionInfo& connectionInfo = netClient->GetSocket()->GetConnectionInfo();
+        AsyncLogger::PrintSuccess("[Network/Socket]: CMD: %u, Size: %u, Lane: %u", packet->header.opcode, packet->header.size, static_cast<u8>(lane));
+#endif // NC_Debug
+
+        // The handler works on the lane slot, which the read stage may reuse as soon as we pop it
+        bool didHandle = netPacketHandler->CallHandler(netClient, PacketLanes::MakeHandle(packet));
+        packetLanes.Pop(lane);
+
+        if (!didHandle)
+            return false;
+    }
+
+    return true;
+}
+void ConnectionUpdateSystem::HandleDisconnect(NetTransport& transport)
+{
+#ifdef NC_Debug
+    const NetSocket::ConnectionInfo& connectionInfo = transport.GetConnectionInfo();
     DebugHandler::PrintWarning("[Network/Socket]: Disconnected from (%s, %u)", connectionInfo.ipAddrStr.c_str(), connectionInfo.port);
 #endif // NC_Debug
+
+    entt::registry* registry = ServiceLocator::GetRegistry();
+    registry->ctx<AdmissionSingleton>().RemoveConnection(transport.GetClient().get());
 }
\ No newline at end of file
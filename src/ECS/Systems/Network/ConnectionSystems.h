@@ -1,8 +1,12 @@
 #pragma once
 #include <entity/fwd.hpp>
 #include <Utils/ConcurrentQueue.h>
+#include "../../Components/Network/ConnectionSingleton.h"
 
 class NetClient;
+class NetTransport;
+class Bytebuffer;
+struct TrafficCaptureSingleton;
 namespace moddycamel
 {
     class ConcurrentQueue;
@@ -10,10 +14,21 @@ namespace moddycamel
 class ConnectionUpdateSystem
 {
 public:
-    static void Update(entt::registry& registry);
+    // The update is a pipeline, UpdateRead frames packets into the lanes while UpdateDispatch runs their handlers on another worker
+    // UpdateFlush runs once both are done, it is the only stage which writes to the transport, closes it or handles its disconnect
+    static void UpdateRead(entt::registry& registry);
+    static void UpdateDispatch(entt::registry& registry);
+    static void UpdateFlush(entt::registry& registry);
 
     // Handlers for Network Client
-    static void HandleRead(std::shared_ptr<NetClient> netClient);
-    static void HandleConnect(std::shared_ptr<NetClient> netClient, bool connected);
-    static void HandleDisconnect(std::shared_ptr<NetClient> netClient);
+    static bool HandleRead(NetTransport& transport);
+    static void HandleConnect(NetTransport& transport, bool connected);
+    static void HandleDisconnect(NetTransport& transport);
+
+    // Splits a stream into packets, returns true if it stopped early because a lane is full. Shared by the live connection and traffic replay
+    static bool FramePackets(Bytebuffer* buffer, PacketLanes& packetLanes, TrafficCaptureSingleton* capture);
+    // Dispatches the control lane before the data lane, returns false if a handler failed, in which case the connection should be closed
+    static bool DispatchPackets(const std::shared_ptr<NetClient>& netClient, PacketLanes& packetLanes);
+    // Applies the outbound queue's watermarks to the transport, returns true while reads are paused
+    static bool UpdateBackpressure(NetTransport& transport);
 };
\ No newline at end of file
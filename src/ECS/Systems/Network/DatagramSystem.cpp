@@ -0,0 +1,196 @@
+#include "DatagramSystem.h"
+#ifndef _WIN32
+#include <entt.hpp>
+#include <chrono>
+#include <cstring>
+#include <Utils/ByteBuffer.h>
+#include <Networking/NetClient.h>
+#include <Networking/NetPacket.h>
+#include <Networking/NetPacketHandler.h>
+#include "../../Components/Singletons/TimeSingleton.h"
+#include "../../Components/Network/DatagramSingleton.h"
+#include "../../Components/Network/ClientComponents.h"
+#include "../../Components/Network/AuthenticationSingleton.h"
+#include "../../Components/Network/ConnectionSingleton.h"
+#include "../../Components/Network/AdmissionSingleton.h"
+#include "../../../Network/Transport/DatagramTransport.h"
+#include "../../../Utils/ServiceLocator.h"
+#include "../../../Utils/AsyncLogger.h"
+#include <tracy/Tracy.hpp>
+
+void DatagramSystem::Update(entt::registry& registry)
+{
+    DatagramSingleton& datagramSingleton = registry.ctx<DatagramSingleton>();
+    if (!datagramSingleton.endpoint.IsOpen())
+        return;
+
+    ZoneScopedNC("DatagramSystem::Update", tracy::Color::Blue)
+
+    AuthenticationSingleton& authenticationSingleton = registry.ctx<AuthenticationSingleton>();
+    ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+    NetPacketHandler* netPacketHandler = ServiceLocator::GetNetPacketHandler();
+    f32 now = registry.ctx<TimeSingleton>().lifeTimeInS;
+
+    // Requesters stamp their datagrams with wall clock time, lifeTime means nothing to them
+    u32 unixTime = static_cast<u32>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+    UdpEndpoint& endpoint = datagramSingleton.endpoint;
+    u64 requestsBefore = datagramSingleton.numRequests;
+
+    for (u32 i = 0; i < datagramSingleton.maxBatchesPerTick; i++)
+    {
+        u32 numReceived = endpoint.Receive();
+        for (u32 j = 0; j < numReceived; j++)
+        {
+            HandleDatagram(registry, datagramSingleton, authenticationSingleton, connectionSingleton, netPacketHandler, j, now, unixTime);
+        }
+
+        // A short batch emptied the socket
+        if (numReceived < UdpEndpoint::BATCH_SIZE)
+            break;
+    }
+
+    // Answers to this tick's requests, along with what the login queue released for datagram requesters last tick
+    auto view = registry.view<DatagramPeer>();
+    view.each([](DatagramPeer& peer)
+    {
+        peer.transport->FlushOutbound();
+    });
+    endpoint.Flush();
+
+    if (now >= datagramSingleton.nextExpiryAt)
+    {
+        ExpirePeers(registry, datagramSingleton, connectionSingleton, now);
+        datagramSingleton.nextExpiryAt = now + datagramSingleton.expiryInterval;
+    }
+
+    TracyPlot("Datagram Requests", static_cast<i64>(datagramSingleton.numRequests - requestsBefore));
+    TracyPlot("Datagram Peers", static_cast<i64>(datagramSingleton.peers.size()));
+}
+
+void DatagramSystem::HandleDatagram(entt::registry& registry, DatagramSingleton& datagramSingleton, AuthenticationSingleton& authenticationSingleton, ConnectionSingleton& connectionSingleton, NetPacketHandler* netPacketHandler, u32 index, f32 now, u32 unixTime)
+{
+    using namespace DatagramProtocol;
+
+    const UdpEndpoint::Datagram& datagram = datagramSingleton.endpoint.GetReceived(index);
+
+    // Until we have logged in there is no key to check against
+    if (!authenticationSingleton.hasDatagramKey || !Verify(authenticationSingleton.datagramKey, datagram.address.sin_addr.s_addr, datagram.address.sin_port, datagram.data, datagram.size))
+    {
+        datagramSingleton.numRejected++;
+        return;
+    }
+
+    DatagramHeader header;
+    std::memcpy(&header, datagram.data, sizeof(header));
+
+    // The request id is appended as the cookie, the handler's size limit has to leave room for it
+    size_t bodySize = datagram.size - OVERHEAD;
+    if (header.magic != MAGIC || header.version != VERSION || header.type != DatagramType::REQUEST_ADDRESS ||
+        bodySize == 0 || bodySize + sizeof(u32) > 128)
+    {
+        datagramSingleton.numMalformed++;
+        return;
+    }
+
+    u32 skew = header.timestamp > unixTime ? header.timestamp - unixTime : unixTime - header.timestamp;
+    if (skew > datagramSingleton.maxClockSkew)
+    {
+        datagramSingleton.numStale++;
+        return;
+    }
+
+    // Only a fresh request gets to create a peer, and a new peer's window accepts it
+    entt::entity entity = entt::null;
+    auto itr = datagramSingleton.peers.find(DatagramSingleton::MakePeerKey(datagram.address));
+    if (itr != datagramSingleton.peers.end())
+        entity = itr->second;
+    else
+        entity = CreatePeer(registry, datagramSingleton, authenticationSingleton, connectionSingleton, index);
+
+    if (entity == entt::null)
+        return;
+
+    DatagramPeer& peer = registry.get<DatagramPeer>(entity);
+    if (!peer.TryAcceptSequence(GetSequence(header)))
+    {
+        datagramSingleton.numReplayed++;
+        return;
+    }
+
+    peer.lastRequestAt = now;
+    peer.numRequests++;
+    datagramSingleton.numRequests++;
+
+    std::shared_ptr<NetPacket> packet = NetPacket::Borrow();
+    packet->header.opcode = Opcode::MSG_REQUEST_ADDRESS;
+    packet->header.size = static_cast<u16>(bodySize + sizeof(u32));
+
+    packet->payload = Bytebuffer::Borrow<128>();
+    packet->payload->size = packet->header.size;
+    packet->payload->writtenData = packet->header.size;
+    std::memcpy(packet->payload->GetDataPointer(), datagram.data + sizeof(DatagramHeader), bodySize);
+    std::memcpy(packet->payload->GetDataPointer() + bodySize, &header.requestId, sizeof(u32));
+
+    // A handler failing would close a connection, here it only costs the requester its answer
+    if (!netPacketHandler->CallHandler(peer.transport->GetClient(), std::move(packet)))
+        datagramSingleton.numMalformed++;
+}
+
+entt::entity DatagramSystem::CreatePeer(entt::registry& registry, DatagramSingleton& datagramSingleton, AuthenticationSingleton& authenticationSingleton, ConnectionSingleton& connectionSingleton, u32 index)
+{
+    const UdpEndpoint::Datagram& datagram = datagramSingleton.endpoint.GetReceived(index);
+    u64 peerKey = DatagramSingleton::MakePeerKey(datagram.address);
+
+    if (datagramSingleton.peers.size() >= datagramSingleton.maxPeers)
+    {
+        datagramSingleton.numOverPeerLimit++;
+        return entt::null;
+    }
+
+    std::shared_ptr<DatagramTransport> transport = std::make_shared<DatagramTransport>(datagramSingleton.endpoint, authenticationSingleton.datagramKey, datagram.address);
+    connectionSingleton.RegisterTransport(transport.get());
+
+    entt::entity entity = registry.create();
+    DatagramPeer& peer = registry.emplace<DatagramPeer>(entity);
+    peer.transport = std::move(transport);
+    peer.peerKey = peerKey;
+
+    datagramSingleton.peers[peerKey] = entity;
+
+#ifdef NC_Debug
+    const NetSocket::ConnectionInfo& connectionInfo = peer.transport->GetConnectionInfo();
+    AsyncLogger::Print("[Network/Datagram]: New requester (%s, %u)", connectionInfo.ipAddrStr.c_str(), connectionInfo.port);
+#endif // NC_Debug
+
+    return entity;
+}
+
+void DatagramSystem::ExpirePeers(entt::registry& registry, DatagramSingleton& datagramSingleton, ConnectionSingleton& connectionSingleton, f32 now)
+{
+    std::vector<entt::entity>& expiredPeers = datagramSingleton.expiredPeers;
+    expiredPeers.clear();
+
+    f32 idleTimeout = datagramSingleton.peerIdleTimeout;
+
+    auto view = registry.view<DatagramPeer>();
+    view.each([&expiredPeers, idleTimeout, now](entt::entity entity, DatagramPeer& peer)
+    {
+        if (now - peer.lastRequestAt >= idleTimeout)
+            expiredPeers.push_back(entity);
+    });
+
+    AdmissionSingleton& admissionSingleton = registry.ctx<AdmissionSingleton>();
+    for (entt::entity entity : expiredPeers)
+    {
+        DatagramPeer& peer = registry.get<DatagramPeer>(entity);
+
+        admissionSingleton.RemoveConnection(peer.transport->GetClient().get());
+        connectionSingleton.UnregisterTransport(peer.transport.get());
+        peer.transport->Close();
+
+        datagramSingleton.peers.erase(peer.peerKey);
+        registry.destroy(entity);
+    }
+}
+#endif // _WIN32
@@ -0,0 +1,22 @@
+#pragma once
+#ifndef _WIN32
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+
+class NetPacketHandler;
+struct DatagramSingleton;
+struct AuthenticationSingleton;
+struct ConnectionSingleton;
+
+class DatagramSystem
+{
+public:
+    // Receives requests in batches and hands them to the address request handler, then sends every answer queued since the last tick in batches. Runs after the upstream connection's stages, it calls the same handlers
+    static void Update(entt::registry& registry);
+
+private:
+    static void HandleDatagram(entt::registry& registry, DatagramSingleton& datagramSingleton, AuthenticationSingleton& authenticationSingleton, ConnectionSingleton& connectionSingleton, NetPacketHandler* netPacketHandler, u32 index, f32 now, u32 unixTime);
+    static entt::entity CreatePeer(entt::registry& registry, DatagramSingleton& datagramSingleton, AuthenticationSingleton& authenticationSingleton, ConnectionSingleton& connectionSingleton, u32 index);
+    static void ExpirePeers(entt::registry& registry, DatagramSingleton& datagramSingleton, ConnectionSingleton& connectionSingleton, f32 now);
+};
+#endif // _WIN32
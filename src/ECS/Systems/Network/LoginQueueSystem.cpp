@@ -0,0 +1,133 @@
+#include "LoginQueueSystem.h"
+#include <entt.hpp>
+#include <Networking/NetStructures.h>
+#include <Networking/NetClient.h>
+#include "../../Components/Network/LoadBalanceSingleton.h"
+#include "../../Components/Network/PlacementSingleton.h"
+#include "../../Components/Network/ConnectionSingleton.h"
+#include "../../Components/Network/AdmissionSingleton.h"
+#include "../../Components/Network/LoginQueueSingleton.h"
+#include <tracy/Tracy.hpp>
+
+void LoginQueueSystem::Update(entt::registry& registry)
+{
+    LoginQueueSingleton& loginQueueSingleton = registry.ctx<LoginQueueSingleton>();
+    TracyPlot("Login Queue Waiting", static_cast<i64>(loginQueueSingleton.numWaiting));
+
+    if (loginQueueSingleton.numWaiting == 0)
+        return;
+
+    ZoneScopedNC("LoginQueueSystem::Update", tracy::Color::Blue)
+
+    LoadBalanceSingleton& loadBalanceSingleton = registry.ctx<LoadBalanceSingleton>();
+    PlacementSingleton& placementSingleton = registry.ctx<PlacementSingleton>();
+    ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+
+    f32 now = loadBalanceSingleton.GetTime();
+
+    for (auto& realm : loginQueueSingleton.realms)
+    {
+        RealmQueue& realmQueue = realm.second;
+        if (realmQueue.requests.empty())
+            continue;
+
+        Release(loadBalanceSingleton, placementSingleton, connectionSingleton, loginQueueSingleton, realm.first, realmQueue);
+
+        f32 elapsed = now - realmQueue.windowStart;
+        if (elapsed >= LoginQueueSingleton::RELEASE_WINDOW)
+        {
+            // Smoothed so a single window in which nothing finished does not throw every estimate off
+            f32 releasesPerSecond = realmQueue.windowReleases / elapsed;
+            realmQueue.releasesPerSecond = realmQueue.releasesPerSecond > 0.0f ? (realmQueue.releasesPerSecond + releasesPerSecond) * 0.5f : releasesPerSecond;
+            realmQueue.windowReleases = 0;
+            realmQueue.windowStart = now;
+        }
+
+        if (!realmQueue.requests.empty() && now >= realmQueue.nextUpdateAt)
+        {
+            SendPositions(connectionSingleton, loginQueueSingleton, realmQueue);
+            realmQueue.nextUpdateAt = now + loginQueueSingleton.updateInterval;
+        }
+    }
+}
+
+void LoginQueueSystem::Release(LoadBalanceSingleton& loadBalanceSingleton, PlacementSingleton& placementSingleton, ConnectionSingleton& connectionSingleton, LoginQueueSingleton& loginQueueSingleton, u8 realmId, RealmQueue& realmQueue)
+{
+    while (!realmQueue.requests.empty())
+    {
+        QueuedRequest& request = realmQueue.requests.front();
+
+        // Nobody is left to tell, don't reserve capacity for it
+        std::shared_ptr<NetClient> netClient = request.netClient.lock();
+        if (!netClient || !connectionSingleton.GetTransport(netClient))
+        {
+            loginQueueSingleton.PopFront(realmQueue);
+            continue;
+        }
+
+        const ServerEntry* serverEntry = placementSingleton.Place(loadBalanceSingleton, realmId, request.sizeHint);
+        if (!serverEntry)
+            break;
+
+        std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<512>();
+
+        PacketHeader header;
+        header.opcode = Opcode::SMSG_SEND_ADDRESS;
+        header.size = static_cast<u16>(AddressResponseTemplate::SIZE + request.cookie.size());
+
+        if (buffer->Put(header) &&
+            buffer->PutBytes(serverEntry->response.data, AddressResponseTemplate::SIZE) &&
+            buffer->PutBytes(request.cookie.data(), request.cookie.size()))
+        {
+            connectionSingleton.Send(netClient, buffer);
+        }
+
+        loginQueueSingleton.PopFront(realmQueue);
+        loginQueueSingleton.numReleased++;
+        realmQueue.windowReleases++;
+    }
+}
+
+void LoginQueueSystem::SendPositions(ConnectionSingleton& connectionSingleton, LoginQueueSingleton& loginQueueSingleton, RealmQueue& realmQueue)
+{
+    ZoneScopedNC("LoginQueueSystem::SendPositions", tracy::Color::Blue)
+
+    // Compacts the queue in place, the survivors keep their order and with it their sequence order
+    size_t numKept = 0;
+    for (size_t i = 0; i < realmQueue.requests.size(); i++)
+    {
+        QueuedRequest& request = realmQueue.requests[i];
+
+        std::shared_ptr<NetClient> netClient = request.netClient.lock();
+        if (!netClient || !connectionSingleton.GetTransport(netClient))
+        {
+            loginQueueSingleton.Forget(realmQueue, request);
+            continue;
+        }
+
+        u32 position = static_cast<u32>(numKept + 1);
+        u16 etaSeconds = LoginQueueSingleton::GetEta(realmQueue, position);
+
+        std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<512>();
+
+        PacketHeader header;
+        header.opcode = Opcode::SMSG_SEND_ADDRESS;
+        header.size = static_cast<u16>(sizeof(u8) + sizeof(u32) + sizeof(u16) + request.cookie.size());
+
+        if (buffer->Put(header) &&
+            buffer->Put(AddressStatus::QUEUED) &&
+            buffer->PutU32(position) &&
+            buffer->PutU16(etaSeconds) &&
+            buffer->PutBytes(request.cookie.data(), request.cookie.size()))
+        {
+            connectionSingleton.Send(netClient, buffer);
+        }
+
+        if (numKept != i)
+            realmQueue.requests[numKept] = std::move(request);
+
+        numKept++;
+    }
+
+    realmQueue.requests.resize(numKept);
+}
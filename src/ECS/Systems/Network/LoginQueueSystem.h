@@ -0,0 +1,24 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <memory>
+
+class NetClient;
+struct LoadBalanceSingleton;
+struct PlacementSingleton;
+struct ConnectionSingleton;
+struct LoginQueueSingleton;
+struct RealmQueue;
+
+class LoginQueueSystem
+{
+public:
+    // Places waiting requests as instance capacity frees up and keeps the rest informed of their position, runs after the backend systems
+    static void Update(entt::registry& registry);
+
+private:
+    // Strictly in order, a request which does not fit holds back the ones behind it
+    static void Release(LoadBalanceSingleton& loadBalanceSingleton, PlacementSingleton& placementSingleton, ConnectionSingleton& connectionSingleton, LoginQueueSingleton& loginQueueSingleton, u8 realmId, RealmQueue& realmQueue);
+    // Also drops the requests whose connection went away, the ones which waited too long are answered by their deadline timer
+    static void SendPositions(ConnectionSingleton& connectionSingleton, LoginQueueSingleton& loginQueueSingleton, RealmQueue& realmQueue);
+};
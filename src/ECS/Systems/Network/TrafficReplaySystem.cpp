@@ -0,0 +1,176 @@
+#include "TrafficReplaySystem.h"
+#include "ConnectionSystems.h"
+#include <entt.hpp>
+#include <Utils/DebugHandler.h>
+#include "../../../Utils/ServiceLocator.h"
+#include "../../Components/Network/TrafficCaptureSingleton.h"
+#include "../../Components/Network/LoadBalanceSingleton.h"
+#include "../../Components/Network/AuthenticationSingleton.h"
+#include "../../Components/Network/AdmissionSingleton.h"
+#include "../../Components/Network/ProximitySingleton.h"
+#include "../../Components/Network/PlacementSingleton.h"
+#include "../../Components/Network/AffinitySingleton.h"
+#include "../../Components/Network/LoginQueueSingleton.h"
+#include "../../Components/Singletons/TimeSingleton.h"
+#include "../../Components/Singletons/TimerSingleton.h"
+#include <tracy/Tracy.hpp>
+
+void TrafficReplaySystem::Update(entt::registry& registry)
+{
+    TrafficCaptureSingleton& trafficCaptureSingleton = registry.ctx<TrafficCaptureSingleton>();
+    if (!trafficCaptureSingleton.IsReplaying())
+        return;
+
+    ZoneScopedNC("TrafficReplaySystem::Update", tracy::Color::Blue)
+
+    entt::registry& replayRegistry = *trafficCaptureSingleton.replayRegistry;
+    TimeSingleton& timeSingleton = registry.ctx<TimeSingleton>();
+    replayRegistry.ctx<TimeSingleton>() = timeSingleton;
+    replayRegistry.ctx<LoadBalanceSingleton>().SetTime(timeSingleton.lifeTimeInS);
+
+    const std::shared_ptr<Bytebuffer>& buffer = trafficCaptureSingleton.replayBuffer;
+    u64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(TrafficCaptureSingleton::Clock::now() - trafficCaptureSingleton.replayStart).count();
+
+    // At recorded pace we feed every record that is due, when replaying fast we keep going until the capture is exhausted
+    bool isDone = false;
+    bool didFeed = true;
+    while (!isDone && didFeed)
+    {
+        didFeed = false;
+
+        while (true)
+        {
+            if (!trafficCaptureSingleton.hasPendingRecord && !ReadRecord(trafficCaptureSingleton))
+            {
+                isDone = true;
+                break;
+            }
+
+            if (!trafficCaptureSingleton.replayFast && trafficCaptureSingleton.pendingTimestamp > elapsed)
+                break;
+
+            const std::vector<u8>& record = trafficCaptureSingleton.pendingRecord;
+            if (buffer->GetSpace() < record.size())
+                break;
+
+            buffer->PutBytes(record.data(), record.size());
+            trafficCaptureSingleton.hasPendingRecord = false;
+            trafficCaptureSingleton.replayedPackets++;
+            trafficCaptureSingleton.replayedBytes += record.size();
+            didFeed = true;
+        }
+
+        bool isQueueFull = true;
+        while (isQueueFull)
+        {
+            isQueueFull = ConnectionUpdateSystem::FramePackets(buffer.get(), trafficCaptureSingleton.replayPacketLanes, nullptr);
+
+            // Handlers find the registry through the ServiceLocator, so this is the only place they see the scratch state
+            entt::registry* gameRegistry = ServiceLocator::ExchangeRegistry(&replayRegistry);
+            bool didDispatch = ConnectionUpdateSystem::DispatchPackets(trafficCaptureSingleton.replayTransport->GetClient(), trafficCaptureSingleton.replayPacketLanes);
+            ServiceLocator::ExchangeRegistry(gameRegistry);
+
+            if (!didDispatch)
+            {
+                DebugHandler::PrintWarning("[TrafficReplay]: A handler rejected a packet from the capture, stopping replay");
+                FinishReplay(trafficCaptureSingleton);
+                return;
+            }
+
+            trafficCaptureSingleton.replayTransport->FlushOutbound();
+        }
+
+        // Every record is a complete packet, anything left after framing is an invalid header that framing refuses to consume
+        if (buffer->GetActiveSize() > 0)
+        {
+            DebugHandler::PrintWarning("[TrafficReplay]: Capture contains an invalid packet, stopping replay");
+            FinishReplay(trafficCaptureSingleton);
+            return;
+        }
+    }
+
+    if (isDone)
+    {
+        FinishReplay(trafficCaptureSingleton);
+    }
+}
+
+bool TrafficReplaySystem::Start(entt::registry& registry, const std::string& path, bool fast)
+{
+    TrafficCaptureSingleton& trafficCaptureSingleton = registry.ctx<TrafficCaptureSingleton>();
+    if (!trafficCaptureSingleton.StartReplay(path, fast))
+        return false;
+
+    /* Replayed packets go through the real handlers, which would otherwise charge reservations to real backends and let a captured server list overwrite the routing table
+       They run against a scratch registry instead, seeded with the live servers and configuration so a capture of client traffic alone still finds somewhere to go */
+    trafficCaptureSingleton.replayRegistry = std::make_unique<entt::registry>();
+    entt::registry& replayRegistry = *trafficCaptureSingleton.replayRegistry;
+
+    replayRegistry.set<TimeSingleton>(registry.ctx<TimeSingleton>());
+    replayRegistry.set<TimerSingleton>();
+    replayRegistry.set<AuthenticationSingleton>();
+    replayRegistry.set<AdmissionSingleton>(registry.ctx<AdmissionSingleton>());
+    replayRegistry.set<ProximitySingleton>(registry.ctx<ProximitySingleton>());
+    replayRegistry.set<PlacementSingleton>(registry.ctx<PlacementSingleton>());
+    replayRegistry.set<AffinitySingleton>(registry.ctx<AffinitySingleton>());
+
+    ConnectionSingleton& replayConnectionSingleton = replayRegistry.set<ConnectionSingleton>();
+    replayConnectionSingleton.RegisterTransport(trafficCaptureSingleton.replayTransport.get());
+
+    const LoginQueueSingleton& loginQueueSingleton = registry.ctx<LoginQueueSingleton>();
+    LoginQueueSingleton& replayLoginQueueSingleton = replayRegistry.set<LoginQueueSingleton>(replayRegistry);
+    replayLoginQueueSingleton.maxQueueLength = loginQueueSingleton.maxQueueLength;
+    replayLoginQueueSingleton.maxWaitTime = loginQueueSingleton.maxWaitTime;
+    replayLoginQueueSingleton.updateInterval = loginQueueSingleton.updateInterval;
+    replayLoginQueueSingleton.queueFullRetryMs = loginQueueSingleton.queueFullRetryMs;
+
+    const LoadBalanceSingleton& loadBalanceSingleton = registry.ctx<LoadBalanceSingleton>();
+    LoadBalanceSingleton& replayLoadBalanceSingleton = replayRegistry.set<LoadBalanceSingleton>(replayRegistry);
+    replayLoadBalanceSingleton.slowStartWindow = loadBalanceSingleton.slowStartWindow;
+    replayLoadBalanceSingleton.slowStartMinWeight = loadBalanceSingleton.slowStartMinWeight;
+    replayLoadBalanceSingleton.failureThreshold = loadBalanceSingleton.failureThreshold;
+    replayLoadBalanceSingleton.failureWindow = loadBalanceSingleton.failureWindow;
+    replayLoadBalanceSingleton.unhealthyCooldown = loadBalanceSingleton.unhealthyCooldown;
+    replayLoadBalanceSingleton.SetTime(loadBalanceSingleton.GetTime());
+
+    std::vector<u8> snapshot;
+    loadBalanceSingleton.WriteSnapshot(snapshot);
+    replayLoadBalanceSingleton.ReadSnapshot(snapshot);
+    return true;
+}
+
+bool TrafficReplaySystem::ReadRecord(TrafficCaptureSingleton& trafficCaptureSingleton)
+{
+    std::ifstream& stream = trafficCaptureSingleton.replayStream;
+
+    u64 timestamp = 0;
+    u32 size = 0;
+    if (!stream.read(reinterpret_cast<char*>(&timestamp), sizeof(timestamp)) ||
+        !stream.read(reinterpret_cast<char*>(&size), sizeof(size)))
+    {
+        return false;
+    }
+
+    if (size > TrafficCaptureSingleton::REPLAY_BUFFER_SIZE)
+    {
+        DebugHandler::PrintWarning("[TrafficReplay]: Capture record of size (%u) exceeds the replay buffer", size);
+        return false;
+    }
+
+    trafficCaptureSingleton.pendingRecord.resize(size);
+    if (!stream.read(reinterpret_cast<char*>(trafficCaptureSingleton.pendingRecord.data()), size))
+        return false;
+
+    trafficCaptureSingleton.pendingTimestamp = timestamp;
+    trafficCaptureSingleton.hasPendingRecord = true;
+    return true;
+}
+
+void TrafficReplaySystem::FinishReplay(TrafficCaptureSingleton& trafficCaptureSingleton)
+{
+    f64 elapsed = std::chrono::duration<f64>(TrafficCaptureSingleton::Clock::now() - trafficCaptureSingleton.replayStart).count();
+    f64 packetsPerSecond = elapsed > 0.0 ? trafficCaptureSingleton.replayedPackets / elapsed : 0.0;
+
+    DebugHandler::PrintSuccess("[TrafficReplay]: Replayed %llu packets (%llu bytes) in %.3fs, %.0f packets/s", static_cast<unsigned long long>(trafficCaptureSingleton.replayedPackets), static_cast<unsigned long long>(trafficCaptureSingleton.replayedBytes), elapsed, packetsPerSecond);
+    trafficCaptureSingleton.StopReplay();
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <entity/fwd.hpp>
+#include <string>
+
+struct TrafficCaptureSingleton;
+class TrafficReplaySystem
+{
+public:
+    static void Update(entt::registry& registry);
+    // Returns false if the file can't be opened or is not a capture
+    static bool Start(entt::registry& registry, const std::string& path, bool fast);
+
+private:
+    static bool ReadRecord(TrafficCaptureSingleton& trafficCaptureSingleton);
+    static void FinishReplay(TrafficCaptureSingleton& trafficCaptureSingleton);
+};
@@ -0,0 +1,14 @@
+#include "TimerSystem.h"
+#include <entt.hpp>
+#include "../Components/Singletons/TimeSingleton.h"
+#include "../Components/Singletons/TimerSingleton.h"
+#include <tracy/Tracy.hpp>
+
+void TimerSystem::Update(entt::registry& registry)
+{
+    TimeSingleton& timeSingleton = registry.ctx<TimeSingleton>();
+    TimerSingleton& timerSingleton = registry.ctx<TimerSingleton>();
+
+    timerSingleton.wheel.Advance(timeSingleton.lifeTimeInWholeMS);
+    TracyPlot("Pending Timers", static_cast<i64>(timerSingleton.wheel.GetNumPending()));
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <entity/fwd.hpp>
+
+class TimerSystem
+{
+public:
+    // Fires the timers that came due this tick, runs after every other system so callbacks never race one
+    static void Update(entt::registry& registry);
+};
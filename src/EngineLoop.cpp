@@ -1,6 +1,11 @@
 #include "EngineLoop.h"
 #include <thread>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
 #include <Utils/Timer.h>
+#include "Utils/EngineClock.h"
 #include <Utils/DebugHandler.h>
 #include "Utils/ServiceLocator.h"
 #include <Networking/NetClient.h>
@@ -9,14 +14,35 @@
 
 // Component Singletons
 #include "ECS/Components/Singletons/TimeSingleton.h"
+#include "ECS/Components/Singletons/TimerSingleton.h"
 #include "ECS/Components/Network/ConnectionSingleton.h"
 #include "ECS/Components/Network/AuthenticationSingleton.h"
 #include "ECS/Components/Network/LoadBalanceSingleton.h"
+#include "ECS/Components/Network/TrafficCaptureSingleton.h"
+#include "ECS/Components/Network/AdmissionSingleton.h"
+#include "ECS/Components/Network/ProximitySingleton.h"
+#include "ECS/Components/Network/PlacementSingleton.h"
+#include "ECS/Components/Network/AffinitySingleton.h"
+#include "ECS/Components/Network/LoginQueueSingleton.h"
+#include "ECS/Components/Network/ClientListenerSingleton.h"
+#include "ECS/Components/Network/DatagramSingleton.h"
 
 // Components
 
 // Systems
 #include "ECS/Systems/Network/ConnectionSystems.h"
+#include "ECS/Systems/Network/TrafficReplaySystem.h"
+#include "ECS/Systems/Network/BackendSystems.h"
+#include "ECS/Systems/Network/LoginQueueSystem.h"
+#include "ECS/Systems/Network/ClientListenerSystem.h"
+#include "ECS/Systems/Network/DatagramSystem.h"
+#include "ECS/Systems/TimerSystem.h"
+
+// Transports
+#include "Network/Transport/SocketTransport.h"
+#include "Network/Transport/MemoryTransport.h"
+#include "Network/Transport/IoUringTransport.h"
+#include "Network/Transport/PosixTransport.h"
 
 // Handlers
 #include "Network/Handlers/Auth/AuthHandlers.h"
@@ -24,10 +50,12 @@
 
 #ifdef WIN32
 #include "Winsock.h"
+#else
+#include <unistd.h>
 #endif
 
-EngineLoop::EngineLoop()
-    : _isRunning(false), _inputQueue(256), _outputQueue(16)
+EngineLoop::EngineLoop(const EngineSettings& settings)
+    : _isRunning(false), _inputQueue(256), _outputQueue(16), _settings(settings)
 {
 #ifdef WIN32
     WSADATA data;
@@ -38,6 +66,10 @@ EngineLoop::EngineLoop()
     }
 #endif
 
+    // Simulation runs against an in-memory upstream
+    if (_settings.simulation.enabled)
+        return;
+
     _network.client = std::make_shared<NetClient>();
     _network.client->Init(NetSocket::Mode::TCP);
 
@@ -90,47 +122,163 @@ void EngineLoop::Run()
     SetupUpdateFramework();
 
     TimeSingleton& timeSingleton = _updateFramework.gameRegistry.set<TimeSingleton>();
+    TimerSingleton& timerSingleton = _updateFramework.gameRegistry.set<TimerSingleton>();
     ConnectionSingleton& connectionSingleton = _updateFramework.gameRegistry.set<ConnectionSingleton>();
-    LoadBalanceSingleton& loadBalanceSingleton = _updateFramework.gameRegistry.set<LoadBalanceSingleton>();
+    LoadBalanceSingleton& loadBalanceSingleton = _updateFramework.gameRegistry.set<LoadBalanceSingleton>(_updateFramework.gameRegistry);
+    loadBalanceSingleton.slowStartWindow = _settings.slowStartWindow;
     AuthenticationSingleton& authenticationSingleton = _updateFramework.gameRegistry.set<AuthenticationSingleton>();
+    AdmissionSingleton& admissionSingleton = _updateFramework.gameRegistry.set<AdmissionSingleton>();
+    connectionSingleton.isPipelined = IsUpdatePipelined();
+    _updateFramework.gameRegistry.set<TrafficCaptureSingleton>();
+    _updateFramework.gameRegistry.set<ProximitySingleton>();
+    _updateFramework.gameRegistry.set<PlacementSingleton>();
+    AffinitySingleton& affinitySingleton = _updateFramework.gameRegistry.set<AffinitySingleton>();
+    _updateFramework.gameRegistry.set<LoginQueueSingleton>(_updateFramework.gameRegistry);
+#ifndef _WIN32
+    ClientListenerSingleton& clientListenerSingleton = _updateFramework.gameRegistry.set<ClientListenerSingleton>();
+    DatagramSingleton& datagramSingleton = _updateFramework.gameRegistry.set<DatagramSingleton>();
+#endif // _WIN32
+
+    u64 pruneInterval = TimerSingleton::ToTicks(AdmissionSingleton::IDLE_BUCKET_TIMEOUT);
+    timerSingleton.wheel.Schedule(pruneInterval, AdmissionSingleton::OnPruneTimer, &admissionSingleton, 0, pruneInterval);
+
+    if (!_settings.zoneFile.empty())
+        LoadZones(_settings.zoneFile);
+
+    std::unique_ptr<EngineClock> clock = nullptr;
+    std::unique_ptr<SimulatedUpstream> simulatedUpstream = nullptr;
+    f32 targetDelta = 1.0f / 5.0f;
 
-    connectionSingleton.netClient = _network.client;
-    bool didConnect = connectionSingleton.netClient->Connect("127.0.0.1", 8000);
-    ConnectionUpdateSystem::HandleConnect(connectionSingleton.netClient, didConnect);
+    if (_settings.simulation.enabled)
+    {
+        std::shared_ptr<MemoryTransport> memoryTransport = std::make_shared<MemoryTransport>();
+        connectionSingleton.transport = memoryTransport;
+        connectionSingleton.RegisterTransport(memoryTransport.get());
 
-    Timer timer;
-    f32 targetDelta = 1.0f / 5.0f;
+        simulatedUpstream = std::make_unique<SimulatedUpstream>(_settings.simulation, memoryTransport);
+        simulatedUpstream->Connect();
+
+        clock = std::make_unique<VirtualClock>(targetDelta);
+    }
+    else
+    {
+        // A hot restart inherits the upstream connection, it is already logged in
+        bool didTakeOver = false;
+#ifndef _WIN32
+        didTakeOver = !_settings.handoffPath.empty() && TakeOver(connectionSingleton, loadBalanceSingleton);
+#endif // _WIN32
+
+        if (!didTakeOver)
+        {
+            connectionSingleton.transport = CreateUpstreamTransport();
+            connectionSingleton.RegisterTransport(connectionSingleton.transport.get());
+
+            bool didConnect = false;
+#ifdef NC_IO_URING
+            if (IoUringTransport* ioUringTransport = dynamic_cast<IoUringTransport*>(connectionSingleton.transport.get()))
+                didConnect = ioUringTransport->Connect("127.0.0.1", 8000);
+            else
+#endif // NC_IO_URING
+#ifndef _WIN32
+            if (PosixTransport* posixTransport = dynamic_cast<PosixTransport*>(connectionSingleton.transport.get()))
+                didConnect = posixTransport->Connect("127.0.0.1", 8000);
+            else
+#endif // _WIN32
+                didConnect = _network.client->Connect("127.0.0.1", 8000);
+
+            ConnectionUpdateSystem::HandleConnect(*connectionSingleton.transport, didConnect);
+        }
+
+#ifndef _WIN32
+        if (!_settings.handoffPath.empty() && !_hotRestart.Listen(_settings.handoffPath))
+            DebugHandler::PrintWarning("[HotRestart]: Could not listen on %s, hot restarts are disabled", _settings.handoffPath.c_str());
+
+        if (_settings.listenPort != 0)
+        {
+            if (clientListenerSingleton.Listen(_settings.listenAddress, _settings.listenPort))
+                DebugHandler::PrintSuccess("[Network/Listener]: Accepting direct clients on (%s, %u)", _settings.listenAddress.c_str(), _settings.listenPort);
+            else
+                DebugHandler::PrintWarning("[Network/Listener]: Could not listen on (%s, %u), direct clients are disabled", _settings.listenAddress.c_str(), _settings.listenPort);
+        }
+
+        if (_settings.datagramPort != 0)
+        {
+            if (datagramSingleton.Open(_settings.datagramAddress, _settings.datagramPort))
+                DebugHandler::PrintSuccess("[Network/Datagram]: Accepting datagram requests on (%s, %u)", _settings.datagramAddress.c_str(), _settings.datagramPort);
+            else
+                DebugHandler::PrintWarning("[Network/Datagram]: Could not bind (%s, %u), datagram requests are disabled", _settings.datagramAddress.c_str(), _settings.datagramPort);
+        }
+#endif // _WIN32
+
+        clock = std::make_unique<WallClock>();
+    }
+
+    auto simulationStart = std::chrono::steady_clock::now();
 
     while (true)
     {
-        f32 deltaTime = timer.GetDeltaTime();
-        timer.Tick();
+        f32 deltaTime = clock->GetDeltaTime();
+        clock->Tick();
 
-        timeSingleton.lifeTimeInS = timer.GetLifeTime();
+        f64 lifeTime = clock->GetLifeTime();
+        timeSingleton.lifeTimeInS = static_cast<f32>(lifeTime);
         timeSingleton.lifeTimeInMS = timeSingleton.lifeTimeInS * 1000;
+        timeSingleton.lifeTimeInWholeMS = static_cast<u64>(lifeTime * 1000.0);
         timeSingleton.deltaTime = deltaTime;
+        loadBalanceSingleton.SetTime(timeSingleton.lifeTimeInS);
+
+        if (simulatedUpstream)
+            simulatedUpstream->Update();
 
+        auto updateStart = std::chrono::steady_clock::now();
         if (!Update())
             break;
 
+        // Simulations don't measure the real tick time, it would make runs with the same seed diverge
+        if (!simulatedUpstream)
         {
-            ZoneScopedNC("WaitForTickRate", tracy::Color::AntiqueWhite1)
+            f32 updateTime = std::chrono::duration<f32>(std::chrono::steady_clock::now() - updateStart).count();
+            bool wasShedding = admissionSingleton.isShedding;
+            admissionSingleton.UpdateLoad(updateTime, targetDelta);
 
-                // Wait for tick rate, this might be an overkill implementation but it has the even tickrate I've seen - MPursche
+            if (admissionSingleton.isShedding != wasShedding)
             {
-                ZoneScopedNC("Sleep", tracy::Color::AntiqueWhite1) for (deltaTime = timer.GetDeltaTime(); deltaTime < targetDelta - 0.0025f; deltaTime = timer.GetDeltaTime())
-                {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                }
+                if (admissionSingleton.isShedding)
+                    PrintMessage("[Admission]: Tick took %.2fms, shedding load", updateTime * 1000.0f);
+                else
+                    PrintMessage("[Admission]: Tick back within budget, stopped shedding load");
             }
+        }
+
+        TracyPlot("Admission Rejected", static_cast<i64>(admissionSingleton.numRejected));
+        TracyPlot("Affinity Hits", static_cast<i64>(affinitySingleton.numHits));
+        TracyPlot("Affinity Entries", static_cast<i64>(affinitySingleton.table.GetSize()));
+
+        if (_topInterval > 0.0f && timeSingleton.lifeTimeInS >= _nextTopAt)
+        {
+            PrintTop();
+            _nextTopAt = timeSingleton.lifeTimeInS + _topInterval;
+        }
+
+#ifndef _WIN32
+        if (_hotRestart.IsListening() && HandOff())
+            break;
+#endif // _WIN32
+
+        if (simulatedUpstream)
+        {
+            simulatedUpstream->Collect();
+
+            if (simulatedUpstream->IsDone(lifeTime))
             {
-                ZoneScopedNC("Yield", tracy::Color::AntiqueWhite1) for (deltaTime = timer.GetDeltaTime(); deltaTime < targetDelta; deltaTime = timer.GetDeltaTime())
-                {
-                    std::this_thread::yield();
-                }
+                f64 wallTime = std::chrono::duration<f64>(std::chrono::steady_clock::now() - simulationStart).count();
+                simulatedUpstream->PrintReport(wallTime);
+                break;
             }
         }
 
+        clock->WaitForTickRate(targetDelta);
+
         FrameMark
     }
 
@@ -165,6 +313,24 @@ bool EngineLoop::Update()
                 pongMessage.message = new std::string("PONG!");
                 _outputQueue.enqueue(pongMessage);
             }
+            else if (message.code == MSG_IN_CAPTURE_START || message.code == MSG_IN_CAPTURE_STOP ||
+                     message.code == MSG_IN_REPLAY || message.code == MSG_IN_REPLAY_FAST)
+            {
+                HandleTrafficCaptureMessage(message);
+            }
+            else if (message.code == MSG_IN_LOAD_ZONES)
+            {
+                LoadZones(*message.message);
+                delete message.message;
+            }
+            else if (message.code == MSG_IN_DRAIN || message.code == MSG_IN_UNDRAIN)
+            {
+                HandleDrainMessage(message);
+            }
+            else if (message.code == MSG_IN_TOP)
+            {
+                HandleTopMessage(message);
+            }
         }
     }
 
@@ -180,12 +346,468 @@ void EngineLoop::SetupUpdateFramework()
     ServiceLocator::SetRegistry(&gameRegistry);
     SetMessageHandler();
 
-    // ConnectionUpdateSystem
-    tf::Task connectionUpdateSystemTask = framework.emplace([&gameRegistry]()
+    // ConnectionUpdateSystem, reading and framing runs alongside dispatch and the two talk over the packet lanes
+    tf::Task connectionReadTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("ConnectionUpdateSystem::UpdateRead", tracy::Color::Blue2)
+        ConnectionUpdateSystem::UpdateRead(gameRegistry);
+    });
+    tf::Task connectionDispatchTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("ConnectionUpdateSystem::UpdateDispatch", tracy::Color::Blue2)
+        ConnectionUpdateSystem::UpdateDispatch(gameRegistry);
+    });
+    tf::Task connectionFlushTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("ConnectionUpdateSystem::UpdateFlush", tracy::Color::Blue2)
+        ConnectionUpdateSystem::UpdateFlush(gameRegistry);
+    });
+
+    // The stages wait on each other, with a single worker they have to run one after the other
+    if (IsUpdatePipelined())
+    {
+        connectionFlushTask.succeed(connectionReadTask, connectionDispatchTask);
+    }
+    else
+    {
+        connectionDispatchTask.succeed(connectionReadTask);
+        connectionFlushTask.succeed(connectionDispatchTask);
+    }
+
+    // ClientListenerSystem and DatagramSystem, direct clients call the same handlers so they wait for the live connection's stages
+    tf::Task handlersDoneTask = connectionFlushTask;
+#ifndef _WIN32
+    tf::Task clientListenerSystemTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("ClientListenerSystem::Update", tracy::Color::Blue2)
+        ClientListenerSystem::Update(gameRegistry);
+    });
+    clientListenerSystemTask.succeed(connectionFlushTask);
+
+    // DatagramSystem
+    tf::Task datagramSystemTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("DatagramSystem::Update", tracy::Color::Blue2)
+        DatagramSystem::Update(gameRegistry);
+    });
+    datagramSystemTask.succeed(clientListenerSystemTask);
+    handlersDoneTask = datagramSystemTask;
+#endif // _WIN32
+
+    // TrafficReplaySystem, it calls the same handlers as well
+    tf::Task trafficReplaySystemTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("TrafficReplaySystem::Update", tracy::Color::Blue2)
+        TrafficReplaySystem::Update(gameRegistry);
+    });
+    trafficReplaySystemTask.succeed(handlersDoneTask);
+
+    // The backend systems read what the handlers of both connections recorded this tick
+    // They are chained rather than run side by side, creating a view can add a storage to the registry
+    // BackendStatsSystem
+    tf::Task backendStatsSystemTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("BackendStatsSystem::Update", tracy::Color::Blue2)
+        BackendStatsSystem::Update(gameRegistry);
+    });
+    backendStatsSystemTask.succeed(trafficReplaySystemTask);
+
+    // BackendHealthSystem
+    tf::Task backendHealthSystemTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("BackendHealthSystem::Update", tracy::Color::Blue2)
+        BackendHealthSystem::Update(gameRegistry);
+    });
+    backendHealthSystemTask.succeed(backendStatsSystemTask);
+
+    // BackendSelectionSystem
+    tf::Task backendSelectionSystemTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("BackendSelectionSystem::Update", tracy::Color::Blue2)
+        BackendSelectionSystem::Update(gameRegistry);
+    });
+    backendSelectionSystemTask.succeed(backendHealthSystemTask);
+
+    // LoginQueueSystem, places waiting requests on what the backend systems left selectable
+    tf::Task loginQueueSystemTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("LoginQueueSystem::Update", tracy::Color::Blue2)
+        LoginQueueSystem::Update(gameRegistry);
+    });
+    loginQueueSystemTask.succeed(backendSelectionSystemTask);
+
+    // TimerSystem, last so timer callbacks may touch any singleton
+    tf::Task timerSystemTask = framework.emplace([&gameRegistry]()
+    {
+        ZoneScopedNC("TimerSystem::Update", tracy::Color::Blue2)
+        TimerSystem::Update(gameRegistry);
+    });
+    timerSystemTask.succeed(loginQueueSystemTask);
+}
+bool EngineLoop::IsUpdatePipelined()
+{
+    // Pipelined, whether a request is handled before or after a topology change framed later in the tick depends on thread timing
+    // Simulations run the stages one after the other so the same seed always gives the same assignments
+    if (_settings.simulation.enabled)
+        return false;
+
+    return _updateFramework.taskflow.num_workers() > 1;
+}
+std::shared_ptr<NetTransport> EngineLoop::CreateUpstreamTransport()
+{
+    if (_settings.networkBackend == NetworkBackend::IO_URING)
+    {
+#ifdef NC_IO_URING
+        std::shared_ptr<IoUringTransport> ioUringTransport = std::make_shared<IoUringTransport>();
+        if (ioUringTransport->Init())
+            return ioUringTransport;
+
+        DebugHandler::PrintWarning("[Network] io_uring is not supported by this kernel, falling back to sockets");
+#else
+        DebugHandler::PrintWarning("[Network] Built without io_uring support (LOADBALANCER_USE_IO_URING), falling back to sockets");
+#endif // NC_IO_URING
+    }
+    else if (_settings.networkBackend == NetworkBackend::POSIX)
+    {
+#ifndef _WIN32
+        return std::make_shared<PosixTransport>();
+#else
+        DebugHandler::PrintWarning("[Network] The posix backend is not available on Windows, falling back to sockets");
+#endif // _WIN32
+    }
+
+    return std::make_shared<SocketTransport>(_network.client);
+}
+#ifndef _WIN32
+std::shared_ptr<NetTransport> EngineLoop::AdoptUpstreamTransport(i32 socket, const std::vector<u8>& unread)
+{
+#ifdef NC_IO_URING
+    if (_settings.networkBackend == NetworkBackend::IO_URING)
+    {
+        std::shared_ptr<IoUringTransport> ioUringTransport = std::make_shared<IoUringTransport>();
+        if (ioUringTransport->Init() && ioUringTransport->Adopt(socket, unread))
+            return ioUringTransport;
+    }
+#endif // NC_IO_URING
+
+    // NetClient can't take over a socket it did not open, the socket backend adopts into a PosixTransport
+    std::shared_ptr<PosixTransport> posixTransport = std::make_shared<PosixTransport>();
+    posixTransport->Adopt(socket, unread);
+    return posixTransport;
+}
+bool EngineLoop::TakeOver(ConnectionSingleton& connectionSingleton, LoadBalanceSingleton& loadBalanceSingleton)
+{
+    HotRestart::Handoff handoff;
+    if (!_hotRestart.Receive(_settings.handoffPath, handoff))
+        return false;
+
+    if (!loadBalanceSingleton.ReadSnapshot(handoff.snapshot))
+    {
+        DebugHandler::PrintWarning("[HotRestart]: Received a malformed server snapshot, the running process keeps the connection");
+        close(handoff.socket);
+        _hotRestart.Reject();
+        return false;
+    }
+
+    // Nothing may touch the socket before the old process confirms, an io_uring transport arms a receive as soon as it adopts
+    if (!_hotRestart.Acknowledge())
     {
-        ZoneScopedNC("ConnectionUpdateSystem::Update", tracy::Color::Blue2)
-        ConnectionUpdateSystem::Update(gameRegistry);
+        DebugHandler::PrintWarning("[HotRestart]: The running process did not confirm the handoff, it keeps the connection");
+        close(handoff.socket);
+        loadBalanceSingleton.Clear();
+        return false;
+    }
+
+    std::shared_ptr<NetTransport> transport = AdoptUpstreamTransport(handoff.socket, handoff.unread);
+    transport->GetClient()->SetConnectionStatus(static_cast<ConnectionStatus>(handoff.connectionStatus));
+
+    connectionSingleton.transport = transport;
+    connectionSingleton.RegisterTransport(transport.get());
+    connectionSingleton.didHandleDisconnect = false;
+
+    AuthenticationSingleton& authenticationSingleton = _updateFramework.gameRegistry.ctx<AuthenticationSingleton>();
+    if (handoff.datagramKey.size() == authenticationSingleton.datagramKey.size())
+    {
+        std::copy(handoff.datagramKey.begin(), handoff.datagramKey.end(), authenticationSingleton.datagramKey.begin());
+        authenticationSingleton.hasDatagramKey = true;
+    }
+
+    const NetSocket::ConnectionInfo& connectionInfo = transport->GetConnectionInfo();
+    DebugHandler::PrintSuccess("[HotRestart]: Took over the upstream connection to (%s, %u)", connectionInfo.ipAddrStr.c_str(), connectionInfo.port);
+    return true;
+}
+bool EngineLoop::HandOff()
+{
+    i32 peer = _hotRestart.Accept();
+    if (peer < 0)
+        return false;
+
+    entt::registry& registry = _updateFramework.gameRegistry;
+    ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+    LoadBalanceSingleton& loadBalanceSingleton = registry.ctx<LoadBalanceSingleton>();
+    LoginQueueSingleton& loginQueueSingleton = registry.ctx<LoginQueueSingleton>();
+
+    std::shared_ptr<NetTransport> transport = connectionSingleton.transport;
+    if (!transport || !transport->IsConnected())
+    {
+        close(peer);
+        return false;
+    }
+
+    // Nothing is given up before we know the connection can move, the socket backend never can
+    if (!transport->CanDetach())
+    {
+        DebugHandler::PrintWarning("[HotRestart]: The upstream transport can't hand off its connection, run with --network posix or --network io_uring");
+        close(peer);
+        return false;
+    }
+
+    // The whole handoff shares one deadline, our update loop stalls until it completes or fails
+    HotRestart::Clock::time_point start = HotRestart::Clock::now();
+    HotRestart::Clock::time_point deadline = start + std::chrono::milliseconds(HotRestart::TIMEOUT_MS);
+    HotRestart::Clock::time_point flushDeadline = start + std::chrono::milliseconds(HotRestart::TIMEOUT_MS / 2);
+
+    // Everything we sent has to reach the kernel before the new process starts sending on the same stream
+    auto drainSends = [&transport, flushDeadline]()
+    {
+        transport->FlushOutbound();
+        while (transport->GetPendingSendBytes() > 0 && HotRestart::Clock::now() < flushDeadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            transport->Read(); // io_uring reaps its send completions while reading, what it reads goes along as unread
+            transport->Flush();
+        }
+
+        return transport->GetPendingSendBytes() == 0;
+    };
+
+    // A peer that isn't reading fails the handoff here, before the login queue has been given up on
+    if (!drainSends())
+    {
+        DebugHandler::PrintWarning("[HotRestart]: The upstream is not taking our sends, keeping the connection");
+        close(peer);
+        return false;
+    }
+
+    // Requests waiting for capacity are answered before the connection moves, their requesters ask the new process again
+    loginQueueSingleton.ExpireAll();
+    drainSends();
+
+    HotRestart::Handoff handoff;
+    handoff.connectionStatus = static_cast<u8>(transport->GetClient()->GetConnectionStatus());
+    loadBalanceSingleton.WriteSnapshot(handoff.snapshot);
+
+    AuthenticationSingleton& authenticationSingleton = registry.ctx<AuthenticationSingleton>();
+    if (authenticationSingleton.hasDatagramKey)
+        handoff.datagramKey.assign(authenticationSingleton.datagramKey.begin(), authenticationSingleton.datagramKey.end());
+
+    handoff.socket = transport->Detach(handoff.unread);
+    if (handoff.socket < 0)
+    {
+        DebugHandler::PrintWarning("[HotRestart]: The upstream transport still has sends in flight, keeping the connection");
+        close(peer);
+        return false;
+    }
+
+    if (HotRestart::Send(peer, handoff, deadline) && HotRestart::WaitForAcknowledge(peer, deadline) && HotRestart::Confirm(peer, deadline))
+    {
+        close(peer);
+        close(handoff.socket);
+
+        // The new process listens on the same ports, new direct clients and datagrams go to it while our clients are dropped as we exit
+        registry.ctx<ClientListenerSingleton>().listener.Close();
+        registry.ctx<DatagramSingleton>().endpoint.Close();
+        PrintMessage("[HotRestart]: Handed the upstream connection off, exiting");
+        return true;
+    }
+
+    // The new process did not take over, carry on with the socket we still own
+    HotRestart::Abort(peer);
+
+    std::shared_ptr<NetTransport> adopted = AdoptUpstreamTransport(handoff.socket, handoff.unread);
+    adopted->GetClient()->SetConnectionStatus(static_cast<ConnectionStatus>(handoff.connectionStatus));
+
+    connectionSingleton.UnregisterTransport(transport.get());
+    connectionSingleton.transport = adopted;
+    connectionSingleton.RegisterTransport(adopted.get());
+
+    DebugHandler::PrintWarning("[HotRestart]: The new process did not take over, keeping the upstream connection");
+    return false;
+}
+#endif // _WIN32
+void EngineLoop::HandleTrafficCaptureMessage(Message& message)
+{
+    TrafficCaptureSingleton& trafficCaptureSingleton = _updateFramework.gameRegistry.ctx<TrafficCaptureSingleton>();
+
+    if (message.code == MSG_IN_CAPTURE_START)
+    {
+        if (trafficCaptureSingleton.StartCapture(*message.message))
+            PrintMessage("[TrafficCapture]: Capturing to %s", message.message->c_str());
+        else
+            PrintMessage("[TrafficCapture]: Failed to open %s", message.message->c_str());
+    }
+    else if (message.code == MSG_IN_CAPTURE_STOP)
+    {
+        if (trafficCaptureSingleton.IsCapturing())
+        {
+            trafficCaptureSingleton.StopCapture();
+            PrintMessage("[TrafficCapture]: Captured %llu packets", static_cast<unsigned long long>(trafficCaptureSingleton.capturedPackets));
+        }
+    }
+    else
+    {
+        bool fast = message.code == MSG_IN_REPLAY_FAST;
+        if (TrafficReplaySystem::Start(_updateFramework.gameRegistry, *message.message, fast))
+            PrintMessage("[TrafficReplay]: Replaying %s", message.message->c_str());
+        else
+            PrintMessage("[TrafficReplay]: Failed to open %s or it is not a capture", message.message->c_str());
+    }
+
+    delete message.message;
+}
+void EngineLoop::LoadZones(const std::string& path)
+{
+    ProximitySingleton& proximitySingleton = _updateFramework.gameRegistry.ctx<ProximitySingleton>();
+
+    if (proximitySingleton.Load(path))
+        PrintMessage("[Proximity]: Loaded %llu prefixes in %llu zones from %s", static_cast<unsigned long long>(proximitySingleton.prefixTable.GetNumPrefixes()), static_cast<unsigned long long>(proximitySingleton.prefixTable.GetNumZones()), path.c_str());
+    else
+        PrintMessage("[Proximity]: Failed to open %s", path.c_str());
+}
+void EngineLoop::HandleDrainMessage(Message& message)
+{
+    LoadBalanceSingleton& loadBalanceSingleton = _updateFramework.gameRegistry.ctx<LoadBalanceSingleton>();
+    PlacementSingleton& placementSingleton = _updateFramework.gameRegistry.ctx<PlacementSingleton>();
+
+    u32 octets[4] = { 0 };
+    u32 port = 0;
+    if (std::sscanf(message.message->c_str(), "%u.%u.%u.%u:%u", &octets[0], &octets[1], &octets[2], &octets[3], &port) != 5 ||
+        octets[0] > 255 || octets[1] > 255 || octets[2] > 255 || octets[3] > 255 || port > 65535)
+    {
+        PrintMessage("[LoadBalancer]: Invalid server address %s, expected <a.b.c.d>:<port>", message.message->c_str());
+        delete message.message;
+        return;
+    }
+
+    // ServerInformation keeps the address in network byte order
+    u8 addressBytes[4] = { static_cast<u8>(octets[0]), static_cast<u8>(octets[1]), static_cast<u8>(octets[2]), static_cast<u8>(octets[3]) };
+    u32 address = 0;
+    std::memcpy(&address, addressBytes, sizeof(u32));
+
+    bool isDraining = message.code == MSG_IN_DRAIN;
+    if (const ServerEntry* serverEntry = loadBalanceSingleton.SetDraining(address, static_cast<u16>(port), isDraining))
+    {
+        PrintMessage("[LoadBalancer]: %s is %s, %llu assignments handed out, %u instance capacity reserved", message.message->c_str(), isDraining ? "draining" : "no longer draining",
+            static_cast<unsigned long long>(loadBalanceSingleton.GetStats(*serverEntry).totalAssignments), placementSingleton.GetReserved(loadBalanceSingleton, *serverEntry));
+    }
+    else
+    {
+        PrintMessage("[LoadBalancer]: No server at %s", message.message->c_str());
+    }
+
+    delete message.message;
+}
+void EngineLoop::HandleTopMessage(Message& message)
+{
+    if (*message.message == "off")
+    {
+        _topInterval = 0.0f;
+    }
+    else
+    {
+        f32 interval = std::strtof(message.message->c_str(), nullptr);
+        if (interval > 0.0f)
+        {
+            _topInterval = interval;
+            _nextTopAt = 0.0f;
+        }
+        else
+        {
+            PrintMessage("[Top]: Invalid refresh interval %s", message.message->c_str());
+        }
+    }
+
+    delete message.message;
+}
+void EngineLoop::PrintTop()
+{
+    static constexpr size_t MAX_ROWS = 10;
+    static constexpr const char* TYPE_NAMES[] = { "INVALID", "AUTH", "REALM", "WORLD", "INSTANCE", "CHAT", "LOADBALANCE", "REGION" };
+
+    LoadBalanceSingleton& loadBalanceSingleton = _updateFramework.gameRegistry.ctx<LoadBalanceSingleton>();
+    f32 now = loadBalanceSingleton.GetTime();
+
+    std::string* output = new std::string();
+    char line[160];
+
+    std::snprintf(line, sizeof(line), "=== top at %.1fs, refreshing every %.1fs (top off to stop) ===\n", now, _topInterval);
+    *output += line;
+
+    std::vector<u32> ranked;
+    loadBalanceSingleton.ForEachPool([&](AddressType type, u8 realmId, const ServerPool& pool)
+    {
+        if (pool.Size() == 0)
+            return;
+
+        // Busiest first, ties broken by the total so idle pools still show their history
+        ranked.resize(pool.Size());
+        for (u32 i = 0; i < pool.Size(); i++)
+            ranked[i] = i;
+
+        std::sort(ranked.begin(), ranked.end(), [&loadBalanceSingleton, &pool](u32 a, u32 b)
+        {
+            const BackendStats& aStats = loadBalanceSingleton.GetStats(pool.entries[a]);
+            const BackendStats& bStats = loadBalanceSingleton.GetStats(pool.entries[b]);
+            if (aStats.assignmentsPerSecond != bStats.assignmentsPerSecond)
+                return aStats.assignmentsPerSecond > bStats.assignmentsPerSecond;
+
+            return aStats.totalAssignments > bStats.totalAssignments;
+        });
+
+        std::snprintf(line, sizeof(line), "%s realm %u, %u servers\n", TYPE_NAMES[static_cast<u8>(type)], realmId, pool.Size());
+        *output += line;
+        std::snprintf(line, sizeof(line), "  %-21s %12s %10s %10s %9s  %s\n", "address", "assigned", "per sec", "last (s)", "failures", "state");
+        *output += line;
+
+        size_t numRows = std::min(ranked.size(), MAX_ROWS);
+        for (size_t i = 0; i < numRows; i++)
+        {
+            u32 position = ranked[i];
+            const ServerEntry& entry = pool.entries[position];
+            const BackendStats& stats = loadBalanceSingleton.GetStats(entry);
+            const BackendHealth& health = loadBalanceSingleton.GetHealth(entry);
+            const u8* address = reinterpret_cast<const u8*>(&entry.info.address);
+
+            char endpoint[32];
+            std::snprintf(endpoint, sizeof(endpoint), "%u.%u.%u.%u:%u", address[0], address[1], address[2], address[3], entry.info.port);
+
+            char lastAssigned[16] = "never";
+            if (stats.lastAssignedAt >= 0.0f)
+                std::snprintf(lastAssigned, sizeof(lastAssigned), "%.1f", now - stats.lastAssignedAt);
+
+            const char* state = "";
+            if (pool.IsDraining(position))
+                state = "draining";
+            else if (!health.isHealthy)
+                state = "unhealthy";
+            else if (pool.weights[position] < 1.0f)
+                state = "slow start";
+
+            std::snprintf(line, sizeof(line), "  %-21s %12llu %10.1f %10s %9llu  %s\n", endpoint, static_cast<unsigned long long>(stats.totalAssignments), stats.assignmentsPerSecond, lastAssigned, static_cast<unsigned long long>(health.failureReports), state);
+            *output += line;
+        }
+
+        if (ranked.size() > numRows)
+        {
+            std::snprintf(line, sizeof(line), "  ... %u more\n", static_cast<u32>(ranked.size() - numRows));
+            *output += line;
+        }
     });
+
+    Message printMessage;
+    printMessage.code = MSG_OUT_PRINT;
+    printMessage.message = output;
+    _outputQueue.enqueue(printMessage);
 }
 void EngineLoop::SetMessageHandler()
 {
@@ -29,12 +29,55 @@
 #include <Utils/StringUtils.h>
 #include <Utils/ConcurrentQueue.h>
 #include <Networking/NetClient.h>
+#include "Utils/AsyncLogger.h"
+#include "Simulation/SimulatedUpstream.h"
+#include "Network/HotRestart.h"
 
+// Load balancer specific input messages, offset to stay clear of the shared codes in Utils/Message.h
+enum LoadBalancerInputMessages
+{
+    MSG_IN_CAPTURE_START = 1000,
+    MSG_IN_CAPTURE_STOP,
+    MSG_IN_REPLAY,
+    MSG_IN_REPLAY_FAST,
+    MSG_IN_LOAD_ZONES,
+    MSG_IN_DRAIN,
+    MSG_IN_UNDRAIN,
+    MSG_IN_TOP
+};
+
+class NetTransport;
+struct ConnectionSingleton;
+struct LoadBalanceSingleton;
 namespace tf
 {
 class Framework;
 }
 
+enum class NetworkBackend
+{
+    SOCKET,
+    IO_URING, // Linux only, falls back to SOCKET if it isn't compiled in or supported by the kernel
+    POSIX // Not on Windows, a plain socket the load balancer owns itself so hot restarts can hand it off without io_uring
+};
+
+struct EngineSettings
+{
+#ifdef _WIN32
+    NetworkBackend networkBackend = NetworkBackend::SOCKET;
+#else
+    NetworkBackend networkBackend = NetworkBackend::POSIX; // Tracks what the upstream has not read yet, which the socket backend can't tell the outbound queue
+#endif // _WIN32
+    std::string zoneFile; // Prefix to zone table for the proximity policy, disabled if empty
+    std::string handoffPath; // Unix domain socket for hot restarts, disabled if empty
+    std::string listenAddress = "127.0.0.1"; // Direct clients are accepted on this address
+    u16 listenPort = 0; // Port for direct clients, 0 disables the listener
+    std::string datagramAddress = "127.0.0.1"; // Datagram requests are accepted on this address
+    u16 datagramPort = 0; // UDP port for datagram requests, 0 disables the endpoint
+    f32 slowStartWindow = 30.0f; // Seconds a server added while we are running takes to ramp up to its full share, 0 disables slow start
+    SimulationSettings simulation;
+};
+
 struct FrameworkRegistryPair
 {
     entt::registry gameRegistry;
@@ -50,7 +93,7 @@ struct NetworkPair
 class EngineLoop
 {
 public:
-    EngineLoop();
+    EngineLoop(const EngineSettings& settings = EngineSettings());
     ~EngineLoop();
 
     void Start();
@@ -59,16 +102,11 @@ public:
     void PassMessage(Message& message);
     bool TryGetMessage(Message& message);
 
+    // Formatting is deferred to the AsyncLogger thread, message must be a string literal
     template <typename... Args>
-    void PrintMessage(std::string message, Args... args)
+    void PrintMessage(const char* message, Args... args)
     {
-        char str[256];
-        StringUtils::FormatString(str, sizeof(str), message.c_str(), args...);
-
-        Message printMessage;
-        printMessage.code = MSG_OUT_PRINT;
-        printMessage.message = new std::string(str);
-        _outputQueue.enqueue(printMessage);
+        AsyncLogger::Print(message, args...);
     }
 
 private:
@@ -78,6 +116,19 @@ private:
 
     void SetupUpdateFramework();
     void SetMessageHandler();
+    void HandleTrafficCaptureMessage(Message& message);
+    void LoadZones(const std::string& path);
+    void HandleDrainMessage(Message& message);
+    void HandleTopMessage(Message& message);
+    void PrintTop();
+    bool IsUpdatePipelined();
+    std::shared_ptr<NetTransport> CreateUpstreamTransport();
+#ifndef _WIN32
+    std::shared_ptr<NetTransport> AdoptUpstreamTransport(i32 socket, const std::vector<u8>& unread);
+    bool TakeOver(ConnectionSingleton& connectionSingleton, LoadBalanceSingleton& loadBalanceSingleton);
+    // Polled between ticks, returns true once the connection was handed to a new process and we should exit
+    bool HandOff();
+#endif // _WIN32
 private:
     bool _isRunning;
 
@@ -85,4 +136,12 @@ private:
     moodycamel::ConcurrentQueue<Message> _outputQueue;
     FrameworkRegistryPair _updateFramework;
     NetworkPair _network;
+    EngineSettings _settings;
+
+    f32 _topInterval = 0.0f; // 0 while the top view is off
+    f32 _nextTopAt = 0.0f;
+
+#ifndef _WIN32
+    HotRestart _hotRestart;
+#endif // _WIN32
 };
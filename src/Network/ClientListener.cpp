@@ -0,0 +1,69 @@
+#include "ClientListener.h"
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+ClientListener::~ClientListener()
+{
+    Close();
+}
+
+bool ClientListener::Listen(const std::string& address, u16 port, i32 backlog)
+{
+    sockaddr_in socketAddress = {};
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1)
+        return false;
+
+    _listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listener < 0)
+        return false;
+
+    // A hot restart binds the new process while the old one still listens, the old one closes its listener when it exits
+    i32 reuse = 1;
+    setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#ifdef SO_REUSEPORT
+    setsockopt(_listener, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
+#endif // SO_REUSEPORT
+
+    if (bind(_listener, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) < 0 || listen(_listener, backlog) < 0)
+    {
+        Close();
+        return false;
+    }
+
+    fcntl(_listener, F_SETFL, fcntl(_listener, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+i32 ClientListener::Accept()
+{
+    if (_listener < 0)
+        return -1;
+
+    while (true)
+    {
+        i32 socket = accept(_listener, nullptr, nullptr);
+        if (socket >= 0)
+            return socket;
+
+        // The client gave up before we got to it, move on to the next one in the backlog
+        if (errno != ECONNABORTED && errno != EINTR)
+            return -1;
+    }
+}
+
+void ClientListener::Close()
+{
+    if (_listener < 0)
+        return;
+
+    close(_listener);
+    _listener = -1;
+}
+#endif // _WIN32
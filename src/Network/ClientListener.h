@@ -0,0 +1,47 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#ifndef _WIN32
+#include <NovusTypes.h>
+#include <string>
+
+// Non-blocking TCP listener for clients which talk to the load balancer directly instead of through the upstream server
+class ClientListener
+{
+public:
+    ~ClientListener();
+
+    // The address is an IPv4 address to bind to, 0.0.0.0 accepts on every interface
+    bool Listen(const std::string& address, u16 port, i32 backlog);
+    bool IsListening() const { return _listener >= 0; }
+    // Returns a connected non-blocking socket, or -1 once the backlog is empty
+    i32 Accept();
+    void Close();
+
+    i32 GetSocket() const { return _listener; }
+
+private:
+    i32 _listener = -1;
+};
+#endif // _WIN32
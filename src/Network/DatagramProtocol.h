@@ -0,0 +1,108 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <cstring>
+#include "../Utils/Sha256.h"
+
+/*
+    Compact datagrams for single address lookups on the UDP endpoint, each request is answered by exactly one response carrying the same request id.
+    A request is the header, the MSG_REQUEST_ADDRESS payload without a cookie and the tag. A response is the header, the SMSG_SEND_ADDRESS payload without a cookie and the tag.
+    The tag is HMAC-SHA256 under AuthenticationSingleton::datagramKey, truncated to TAG_SIZE, of the requester's IPv4 address and port in network order followed by everything in front of the tag.
+    Covering the address means a captured request can't be replayed from another source, and a response only verifies for the requester it was sent to. Requests that don't carry a valid tag are dropped without an answer.
+    Every datagram carries the sender's Unix time in seconds and a counter, the two never repeat together for one sender. Requests more than DatagramSingleton::maxClockSkew away from our clock, or with a pair the requester has already used, are dropped.
+    Requests are idempotent lookups, so a client that hears nothing back simply sends again with the same request id and a new counter.
+*/
+namespace DatagramProtocol
+{
+    static constexpr u16 MAGIC = 0x554E; // NU
+    static constexpr u8 VERSION = 2;
+    static constexpr size_t TAG_SIZE = 16;
+    static constexpr size_t MAX_DATAGRAM_SIZE = 512;
+
+    enum class DatagramType : u8
+    {
+        REQUEST_ADDRESS = 1,
+        SEND_ADDRESS = 2
+    };
+
+#pragma pack(push, 1)
+    struct DatagramHeader
+    {
+        u16 magic = MAGIC;
+        u8 version = VERSION;
+        DatagramType type = DatagramType::REQUEST_ADDRESS;
+        u32 requestId = 0;
+        u32 timestamp = 0; // Sender's Unix time in seconds
+        u32 sequence = 0; // Sender's counter, it may start over whenever timestamp moves on
+    };
+#pragma pack(pop)
+
+    static constexpr size_t OVERHEAD = sizeof(DatagramHeader) + TAG_SIZE;
+
+    // Orders a sender's datagrams for the replay window, a new second outranks every counter of the one before it
+    inline u64 GetSequence(const DatagramHeader& header)
+    {
+        return (static_cast<u64>(header.timestamp) << 32) | header.sequence;
+    }
+
+    // address and port are the requester's in network order, size must be at most MAX_DATAGRAM_SIZE
+    inline void Hmac(const Sha256::Digest& key, u32 address, u16 port, const u8* data, size_t size, u8* digest)
+    {
+        u8 message[sizeof(u32) + sizeof(u16) + MAX_DATAGRAM_SIZE];
+        std::memcpy(message, &address, sizeof(u32));
+        std::memcpy(message + sizeof(u32), &port, sizeof(u16));
+        std::memcpy(message + sizeof(u32) + sizeof(u16), data, size);
+
+        Sha256::Hmac(key.data(), key.size(), message, sizeof(u32) + sizeof(u16) + size, digest);
+    }
+
+    // Appends the tag, data must have room for TAG_SIZE more bytes after size
+    inline void Sign(const Sha256::Digest& key, u32 address, u16 port, u8* data, size_t size)
+    {
+        u8 digest[Sha256::DIGEST_SIZE];
+        Hmac(key, address, port, data, size, digest);
+        std::memcpy(data + size, digest, TAG_SIZE);
+    }
+
+    // size includes the tag, the comparison takes the same time wherever the tags differ
+    inline bool Verify(const Sha256::Digest& key, u32 address, u16 port, const u8* data, size_t size)
+    {
+        if (size < OVERHEAD || size > MAX_DATAGRAM_SIZE)
+            return false;
+
+        size_t signedSize = size - TAG_SIZE;
+
+        u8 digest[Sha256::DIGEST_SIZE];
+        Hmac(key, address, port, data, signedSize, digest);
+
+        u8 difference = 0;
+        for (size_t i = 0; i < TAG_SIZE; i++)
+        {
+            difference |= digest[i] ^ data[signedSize + i];
+        }
+
+        return difference == 0;
+    }
+}
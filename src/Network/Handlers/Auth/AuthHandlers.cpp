@@ -6,6 +6,7 @@
 #include <Utils/ByteBuffer.h>
 #include "../../../Utils/ServiceLocator.h"
 #include "../../../ECS/Components/Network/AuthenticationSingleton.h"
+#include "../../../ECS/Components/Network/ConnectionSingleton.h"
 
 // @TODO: Remove Temporary Includes when they're no longer needed
 #include <Utils/DebugHandler.h>
@@ -24,11 +25,12 @@ namespace InternalSocket
 
         entt::registry* registry = ServiceLocator::GetRegistry();
         AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
+        ConnectionSingleton& connectionSingleton = registry->ctx<ConnectionSingleton>();
 
         // If "ProcessChallenge" fails, we have either hit a bad memory allocation or a SRP-6a safety check, thus we should close the connection
         if (!authenticationSingleton.srp.ProcessChallenge(logonChallenge.s, logonChallenge.B))
         {
-            netClient->Close();
+            connectionSingleton.GetTransport(netClient)->RequestClose();
             return true;
         }
 
@@ -42,7 +44,7 @@ namespace InternalSocket
 
         u16 payloadSize = clientResponse.Serialize(buffer);
         buffer->Put<u16>(payloadSize, 2);
-        netClient->Send(buffer);
+        connectionSingleton.Send(netClient, buffer);
 
         netClient->SetConnectionStatus(ConnectionStatus::AUTH_HANDSHAKE);
         return true;
@@ -55,11 +57,12 @@ namespace InternalSocket
 
         entt::registry* registry = ServiceLocator::GetRegistry();
         AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
+        ConnectionSingleton& connectionSingleton = registry->ctx<ConnectionSingleton>();
 
         if (!authenticationSingleton.srp.VerifySession(logonResponse.HAMK))
         {
             DebugHandler::PrintWarning("Unsuccessful Login");
-            netClient->Close();
+            connectionSingleton.GetTransport(netClient)->RequestClose();
             return true;
         }
         else
@@ -67,17 +70,19 @@ namespace InternalSocket
             DebugHandler::PrintSuccess("Successful Login");
         }
 
+        authenticationSingleton.DeriveDatagramKey();
+
         std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
         buffer->Put(Opcode::CMSG_CONNECTED);
         buffer->PutU16(8);
         buffer->Put(AddressType::LOADBALANCE);
         buffer->PutU8(0);
 
-        const NetSocket::ConnectionInfo& connectionInfo = netClient->GetSocket()->GetConnectionInfo();
+        const NetSocket::ConnectionInfo& connectionInfo = connectionSingleton.GetTransport(netClient)->GetConnectionInfo();
         buffer->PutU32(connectionInfo.ipAddr);
         buffer->PutU16(connectionInfo.port);
 
-        netClient->Send(buffer);
+        connectionSingleton.Send(netClient, buffer);
 
         netClient->SetConnectionStatus(ConnectionStatus::AUTH_SUCCESS);
         return true;
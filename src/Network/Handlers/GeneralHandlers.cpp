@@ -5,7 +5,15 @@
 #include <Networking/NetPacketHandler.h>
 #include <Networking/PacketUtils.h>
 #include "../../Utils/ServiceLocator.h"
+#include "../../Utils/AsyncLogger.h"
 #include "../../ECS/Components/Network/LoadBalanceSingleton.h"
+#include "../../ECS/Components/Network/ConnectionSingleton.h"
+#include "../../ECS/Components/Network/AdmissionSingleton.h"
+#include "../../ECS/Components/Network/ProximitySingleton.h"
+#include "../../ECS/Components/Network/PlacementSingleton.h"
+#include "../../ECS/Components/Network/AffinitySingleton.h"
+#include "../../ECS/Components/Network/LoginQueueSingleton.h"
+#include "../../ECS/Components/Singletons/TimeSingleton.h"
 
 namespace InternalSocket
 {
@@ -13,6 +21,10 @@ namespace InternalSocket
     {
         netPacketHandler->SetMessageHandler(Opcode::SMSG_CONNECTED, { ConnectionStatus::AUTH_SUCCESS, 0, GeneralHandlers::HandleConnected });
         netPacketHandler->SetMessageHandler(Opcode::MSG_REQUEST_ADDRESS, { ConnectionStatus::CONNECTED, sizeof(AddressType), 128, GeneralHandlers::HandleRequestAddress });
+        netPacketHandler->SetMessageHandler(Opcode::MSG_REQUEST_ADDRESS_BULK, { ConnectionStatus::CONNECTED, sizeof(u16), 8192, GeneralHandlers::HandleRequestAddressBulk });
+        netPacketHandler->SetMessageHandler(Opcode::MSG_INSTANCE_COMPLETE, { ConnectionStatus::CONNECTED, sizeof(u8) + sizeof(u32) + sizeof(u16) + sizeof(u16), GeneralHandlers::HandleInstanceComplete });
+        netPacketHandler->SetMessageHandler(Opcode::MSG_SET_SERVER_DRAINING, { ConnectionStatus::CONNECTED, sizeof(entt::entity) + sizeof(AddressType) + sizeof(u8) + sizeof(u8), GeneralHandlers::HandleSetServerDraining });
+        netPacketHandler->SetMessageHandler(Opcode::MSG_REPORT_SERVER_FAILURE, { ConnectionStatus::CONNECTED, sizeof(u32) + sizeof(u16), GeneralHandlers::HandleReportServerFailure });
         netPacketHandler->SetMessageHandler(Opcode::SMSG_SEND_FULL_INTERNAL_SERVER_INFO, { ConnectionStatus::CONNECTED, sizeof(ServerInformation), 8192, GeneralHandlers::HandleFullServerInfoUpdate });
         netPacketHandler->SetMessageHandler(Opcode::SMSG_SEND_ADD_INTERNAL_SERVER_INFO, { ConnectionStatus::CONNECTED, sizeof(ServerInformation), GeneralHandlers::HandleServerInfoAdd });
         netPacketHandler->SetMessageHandler(Opcode::SMSG_SEND_REMOVE_INTERNAL_SERVER_INFO, { ConnectionStatus::CONNECTED, sizeof(entt::entity) + sizeof(AddressType) + sizeof(u8), GeneralHandlers::HandleServerInfoRemove});
@@ -26,69 +38,396 @@ namespace InternalSocket
     }
     bool GeneralHandlers::HandleRequestAddress(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
     {
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        auto& connectionSingleton = registry->ctx<ConnectionSingleton>();
+
         // Validate that we did get an AddressType and that it is valid
-        AddressType requestType;
-        if (!packet->payload->Get(requestType) ||
-            (requestType < AddressType::AUTH || requestType >= AddressType::COUNT))
-        {
+        AddressRequest request;
+        if (!ReadAddressRequest(packet->payload, TrustsRequesterIds(connectionSingleton, netClient), request))
             return false;
-        }
 
-        entt::registry* registry = ServiceLocator::GetRegistry();
         auto& loadBalanceSingleton = registry->ctx<LoadBalanceSingleton>();
+        auto& admissionSingleton = registry->ctx<AdmissionSingleton>();
+        auto& timeSingleton = registry->ctx<TimeSingleton>();
+        auto& proximitySingleton = registry->ctx<ProximitySingleton>();
+        auto& placementSingleton = registry->ctx<PlacementSingleton>();
+        auto& affinitySingleton = registry->ctx<AffinitySingleton>();
+        auto& loginQueueSingleton = registry->ctx<LoginQueueSingleton>();
 
-        ServerInformation serverInformation;
-        if (requestType == AddressType::AUTH)
+        u8* cookie = packet->payload->GetReadPointer();
+        size_t cookieSize = packet->payload->GetReadSpace();
+
+        std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
+
+        // Over its rate, or we are shedding load, tell the requester when to try again
+        u16 retryAfterMs = 0;
+        if (!admissionSingleton.Admit(netClient.get(), request.hasRequesterId, request.requesterId, timeSingleton.lifeTimeInWholeMS, retryAfterMs))
         {
-            loadBalanceSingleton.Get<AddressType::AUTH>(serverInformation);
+            PacketHeader header;
+            header.opcode = Opcode::SMSG_SEND_ADDRESS;
+            header.size = static_cast<u16>(sizeof(u8) + sizeof(u16) + cookieSize);
+
+            if (!buffer->Put(header) ||
+                !buffer->Put(AddressStatus::BUSY) ||
+                !buffer->PutU16(retryAfterMs) ||
+                !buffer->PutBytes(cookie, cookieSize))
+            {
+                return false;
+            }
+
+            connectionSingleton.Send(netClient, buffer);
+            return true;
         }
-        else if (requestType == AddressType::REALM)
+
+        const ServerEntry* serverEntry = nullptr;
+        if (!MustWait(loginQueueSingleton, request, request.realmId))
         {
-            loadBalanceSingleton.Get<AddressType::REALM>(serverInformation);
+            u16 connectionZone = GetConnectionZone(connectionSingleton, proximitySingleton, netClient);
+            serverEntry = SelectServer(loadBalanceSingleton, proximitySingleton, placementSingleton, affinitySingleton, request, request.realmId, connectionZone, timeSingleton.lifeTimeInS);
         }
-        else if (requestType == AddressType::WORLD)
+
+        AddressStatus queueStatus = AddressStatus::NOT_FOUND;
+        u32 queuePosition = 0;
+        u16 etaSeconds = 0;
+        if (!serverEntry && TryQueue(loginQueueSingleton, loadBalanceSingleton, placementSingleton, netClient, request, request.realmId, cookie, cookieSize, timeSingleton.lifeTimeInS, queueStatus, queuePosition, etaSeconds))
         {
-            loadBalanceSingleton.Get<AddressType::WORLD>(serverInformation);
+            bool isQueued = queueStatus == AddressStatus::QUEUED;
+
+            PacketHeader header;
+            header.opcode = Opcode::SMSG_SEND_ADDRESS;
+            header.size = static_cast<u16>(sizeof(u8) + (isQueued ? sizeof(u32) : 0) + sizeof(u16) + cookieSize);
+
+            if (!buffer->Put(header) ||
+                !buffer->Put(queueStatus) ||
+                (isQueued && !buffer->PutU32(queuePosition)) ||
+                !buffer->PutU16(isQueued ? etaSeconds : loginQueueSingleton.queueFullRetryMs) ||
+                !buffer->PutBytes(cookie, cookieSize))
+            {
+                return false;
+            }
+
+            connectionSingleton.Send(netClient, buffer);
+            return true;
         }
-        else if (requestType == AddressType::INSTANCE)
+
+        // If the load balancer couldn't find a valid server, we send status 0 back
+        if (!serverEntry)
         {
-            loadBalanceSingleton.Get<AddressType::INSTANCE>(serverInformation);
+            if (!PacketUtils::Write_SMSG_SEND_ADDRESS(buffer, 0, 0, 0, cookie, cookieSize))
+                return false;
+
+            connectionSingleton.Send(netClient, buffer);
+            return true;
         }
-        else if (requestType == AddressType::CHAT)
+
+        PacketHeader header;
+        header.opcode = Opcode::SMSG_SEND_ADDRESS;
+        header.size = static_cast<u16>(AddressResponseTemplate::SIZE + cookieSize);
+
+        // The response is the server's pre-encoded status, address & port followed by the echoed cookie
+        if (!buffer->Put(header) ||
+            !buffer->PutBytes(serverEntry->response.data, AddressResponseTemplate::SIZE) ||
+            !buffer->PutBytes(cookie, cookieSize))
         {
-            loadBalanceSingleton.Get<AddressType::CHAT>(serverInformation);
+            return false;
         }
-        else if (requestType == AddressType::LOADBALANCE)
+
+        connectionSingleton.Send(netClient, buffer);
+        return true;
+    }
+    bool GeneralHandlers::HandleRequestAddressBulk(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    {
+        /* Payload: u16 count, followed by count * (AddressType type, [u64 requesterId], [u16 sizeHint], [u32 requesterAddress], u8 realmId, u8 cookieSize, u8[cookieSize] cookie)
+           Response: u16 count, followed by count * (u8 status, [u32 address, u16 port | u16 retryAfterMs | u32 queuePosition, u16 etaSeconds], u8 cookieSize, u8[cookieSize] cookie)
+           The response is split across multiple SMSG_SEND_ADDRESS_BULK packets if it would not fit in a single one */
+        u16 count = 0;
+        if (!packet->payload->GetU16(count) || count == 0 || count > MAX_BULK_ADDRESS_REQUESTS)
+            return false;
+
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        auto& loadBalanceSingleton = registry->ctx<LoadBalanceSingleton>();
+        auto& connectionSingleton = registry->ctx<ConnectionSingleton>();
+        auto& admissionSingleton = registry->ctx<AdmissionSingleton>();
+        auto& timeSingleton = registry->ctx<TimeSingleton>();
+        auto& proximitySingleton = registry->ctx<ProximitySingleton>();
+        auto& placementSingleton = registry->ctx<PlacementSingleton>();
+        auto& affinitySingleton = registry->ctx<AffinitySingleton>();
+        auto& loginQueueSingleton = registry->ctx<LoginQueueSingleton>();
+
+        u16 connectionZone = GetConnectionZone(connectionSingleton, proximitySingleton, netClient);
+        bool trustsRequesterIds = TrustsRequesterIds(connectionSingleton, netClient);
+
+        std::shared_ptr<Bytebuffer> buffer = nullptr;
+        size_t countOffset = 0;
+        u16 numWritten = 0;
+
+        for (u16 i = 0; i < count; i++)
         {
-            loadBalanceSingleton.Get<AddressType::LOADBALANCE>(serverInformation);
+            AddressRequest request;
+            u8 realmId = 0;
+            u8 cookieSize = 0;
+
+            if (!ReadAddressRequest(packet->payload, trustsRequesterIds, request))
+                return false;
+
+            if (!packet->payload->GetU8(realmId))
+                return false;
+
+            request.realmId = realmId;
+
+            if (!packet->payload->GetU8(cookieSize) || cookieSize > packet->payload->GetReadSpace())
+                return false;
+
+            u8* cookie = packet->payload->GetReadPointer();
+            packet->payload->SkipRead(cookieSize);
+
+            // Flush the current response if this entry would not fit (status + address + port + cookieSize + cookie)
+            size_t entrySize = sizeof(u8) + sizeof(u32) + sizeof(u16) + sizeof(u8) + cookieSize;
+            if (buffer && buffer->GetSpace() < entrySize)
+            {
+                FinalizeAddressBulk(buffer, countOffset, numWritten);
+                connectionSingleton.Send(netClient, buffer);
+
+                buffer = nullptr;
+            }
+
+            if (!buffer)
+            {
+                buffer = Bytebuffer::Borrow<8192>();
+                buffer->Put(Opcode::SMSG_SEND_ADDRESS_BULK);
+                buffer->SkipWrite(sizeof(u16));
+
+                countOffset = buffer->writtenData;
+                buffer->SkipWrite(sizeof(u16));
+                numWritten = 0;
+            }
+
+            // Every entry is admitted on its own, a bulk request can't be used to get around the rate limit
+            u16 retryAfterMs = 0;
+            if (!admissionSingleton.Admit(netClient.get(), request.hasRequesterId, request.requesterId, timeSingleton.lifeTimeInWholeMS, retryAfterMs))
+            {
+                buffer->Put(AddressStatus::BUSY);
+                buffer->PutU16(retryAfterMs);
+            }
+            else
+            {
+                const ServerEntry* serverEntry = nullptr;
+                if (!MustWait(loginQueueSingleton, request, realmId))
+                    serverEntry = SelectServer(loadBalanceSingleton, proximitySingleton, placementSingleton, affinitySingleton, request, realmId, connectionZone, timeSingleton.lifeTimeInS);
+
+                // Queued entries get their address later as a SMSG_SEND_ADDRESS carrying the entry's cookie
+                AddressStatus queueStatus = AddressStatus::NOT_FOUND;
+                u32 queuePosition = 0;
+                u16 etaSeconds = 0;
+
+                if (serverEntry)
+                {
+                    buffer->PutBytes(serverEntry->response.data, AddressResponseTemplate::SIZE);
+                }
+                else if (TryQueue(loginQueueSingleton, loadBalanceSingleton, placementSingleton, netClient, request, realmId, cookie, cookieSize, timeSingleton.lifeTimeInS, queueStatus, queuePosition, etaSeconds))
+                {
+                    buffer->Put(queueStatus);
+                    if (queueStatus == AddressStatus::QUEUED)
+                    {
+                        buffer->PutU32(queuePosition);
+                        buffer->PutU16(etaSeconds);
+                    }
+                    else
+                    {
+                        buffer->PutU16(loginQueueSingleton.queueFullRetryMs);
+                    }
+                }
+                else
+                {
+                    // If the load balancer couldn't find a valid server, we send status 0 back
+                    buffer->Put(AddressStatus::NOT_FOUND);
+                }
+            }
+
+            buffer->PutU8(cookieSize);
+            buffer->PutBytes(cookie, cookieSize);
+            numWritten++;
         }
-        else if (requestType == AddressType::REGION)
+
+        FinalizeAddressBulk(buffer, countOffset, numWritten);
+        connectionSingleton.Send(netClient, buffer);
+        return true;
+    }
+    bool GeneralHandlers::HandleSetServerDraining(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    {
+        // Payload: entt::entity entity, AddressType type, u8 realmId, u8 isDraining
+        entt::entity entity = entt::null;
+        AddressType type = AddressType::INVALID;
+        u8 realmId = 0;
+        u8 isDraining = 0;
+
+        if (!packet->payload->Get(entity))
+            return false;
+
+        if (!packet->payload->Get(type) ||
+            (type < AddressType::AUTH || type >= AddressType::COUNT))
         {
-            loadBalanceSingleton.Get<AddressType::REGION>(serverInformation);
+            return false;
         }
 
-        std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
-        u8 status = 1;
+        if (!packet->payload->GetU8(realmId) || !packet->payload->GetU8(isDraining))
+            return false;
 
-        // If the load balancer couldn't find a valid server, we send status 0 back
-        if (serverInformation.type == AddressType::INVALID)
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        auto& loadBalanceSingleton = registry->ctx<LoadBalanceSingleton>();
+        auto& placementSingleton = registry->ctx<PlacementSingleton>();
+
+        // The server may already have been removed, that is not an error
+        const ServerEntry* serverEntry = loadBalanceSingleton.SetDraining(type, entity, realmId, isDraining != 0);
+        if (serverEntry)
         {
-            status = 0;
+            AsyncLogger::Print("[LoadBalancer]: Server (%u) is %s, %llu assignments handed out, %u instance capacity reserved", static_cast<u32>(entity), isDraining ? "draining" : "no longer draining",
+                static_cast<unsigned long long>(loadBalanceSingleton.GetStats(*serverEntry).totalAssignments), placementSingleton.GetReserved(loadBalanceSingleton, *serverEntry));
         }
 
-        if (!PacketUtils::Write_SMSG_SEND_ADDRESS(buffer, status, serverInformation.address, serverInformation.port, packet->payload->GetReadPointer(), packet->payload->GetReadSpace()))
+        return true;
+    }
+    bool GeneralHandlers::HandleReportServerFailure(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    {
+        // Payload: u32 address, u16 port, the server the requester was given but could not reach
+        u32 address = 0;
+        u16 port = 0;
+
+        if (!packet->payload->GetU32(address) || !packet->payload->GetU16(port))
+            return false;
+
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        registry->ctx<LoadBalanceSingleton>().ReportFailure(address, port);
+        return true;
+    }
+    bool GeneralHandlers::HandleInstanceComplete(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    {
+        // Payload: u8 realmId, u32 address, u16 port, u16 size, the server and size the instance was placed with
+        u8 realmId = 0;
+        u32 address = 0;
+        u16 port = 0;
+        u16 size = 0;
+
+        if (!packet->payload->GetU8(realmId) ||
+            !packet->payload->GetU32(address) ||
+            !packet->payload->GetU16(port) ||
+            !packet->payload->GetU16(size))
+        {
             return false;
+        }
+
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        auto& loadBalanceSingleton = registry->ctx<LoadBalanceSingleton>();
+        auto& placementSingleton = registry->ctx<PlacementSingleton>();
 
-        netClient->Send(buffer);
+        // The server may have been removed while the instance was running, there is nothing left to release then
+        placementSingleton.Release(loadBalanceSingleton, realmId, address, port, size);
         return true;
     }
+    bool GeneralHandlers::ReadAddressRequest(std::shared_ptr<Bytebuffer>& payload, bool trustsRequesterIds, AddressRequest& request)
+    {
+        constexpr u8 flags = AdmissionSingleton::REQUESTER_ID_FLAG | PlacementSingleton::INSTANCE_SIZE_FLAG | LoadBalanceSingleton::REALM_ID_FLAG | ProximitySingleton::REQUESTER_ADDRESS_FLAG;
+
+        u8 rawType = 0;
+        if (!payload->GetU8(rawType))
+            return false;
+
+        // Requesters which identify themselves are rate limited on their own instead of sharing the connection's limit
+        request.hasRequesterId = (rawType & AdmissionSingleton::REQUESTER_ID_FLAG) != 0;
+        if (request.hasRequesterId && !payload->GetU64(request.requesterId))
+            return false;
+
+        // An untrusted sender's id is read past and dropped, its requests share its connection's limit and don't touch affinity
+        if (!trustsRequesterIds)
+        {
+            request.hasRequesterId = false;
+            request.requesterId = 0;
+        }
+
+        if ((rawType & PlacementSingleton::INSTANCE_SIZE_FLAG) && !payload->GetU16(request.sizeHint))
+            return false;
+
+        if ((rawType & LoadBalanceSingleton::REALM_ID_FLAG) && !payload->GetU8(request.realmId))
+            return false;
+
+        request.hasRequesterAddress = (rawType & ProximitySingleton::REQUESTER_ADDRESS_FLAG) != 0;
+        if (request.hasRequesterAddress && !payload->GetU32(request.requesterAddress))
+            return false;
+
+        request.type = static_cast<AddressType>(rawType & ~flags);
+        return request.type >= AddressType::AUTH && request.type < AddressType::COUNT;
+    }
+    bool GeneralHandlers::TrustsRequesterIds(ConnectionSingleton& connectionSingleton, const std::shared_ptr<NetClient>& netClient)
+    {
+        NetTransport* transport = connectionSingleton.GetTransport(netClient);
+        return transport && transport->TrustsRequesterIds();
+    }
+    u16 GeneralHandlers::GetConnectionZone(ConnectionSingleton& connectionSingleton, ProximitySingleton& proximitySingleton, const std::shared_ptr<NetClient>& netClient)
+    {
+        if (!proximitySingleton.IsEnabled())
+            return PrefixTable::INVALID_ZONE;
+
+        NetTransport* transport = connectionSingleton.GetTransport(netClient);
+        if (!transport)
+            return PrefixTable::INVALID_ZONE;
+
+        return proximitySingleton.GetZone(transport->GetConnectionInfo().ipAddr);
+    }
+    const ServerEntry* GeneralHandlers::SelectServer(LoadBalanceSingleton& loadBalanceSingleton, ProximitySingleton& proximitySingleton, PlacementSingleton& placementSingleton, AffinitySingleton& affinitySingleton, const AddressRequest& request, u8 realmId, u16 connectionZone, f32 now)
+    {
+        // Sized instances are placed by capacity, if nothing has room the requester gets status 0 rather than an overcommitted server
+        if (request.type == AddressType::INSTANCE && request.sizeHint > 0)
+            return placementSingleton.Place(loadBalanceSingleton, realmId, request.sizeHint);
+
+        bool useAffinity = request.hasRequesterId && affinitySingleton.IsEnabled(request.type);
+        if (useAffinity)
+        {
+            if (const ServerEntry* serverEntry = affinitySingleton.Select(loadBalanceSingleton, request.type, realmId, request.requesterId, now))
+                return serverEntry;
+        }
+
+        // Behind an upstream the connection's address is the upstream's own, only the relayed requester address places the requester
+        u16 requesterZone = request.hasRequesterAddress ? proximitySingleton.GetZone(request.requesterAddress) : connectionZone;
+        const ServerEntry* serverEntry = proximitySingleton.Select(loadBalanceSingleton, request.type, realmId, requesterZone, now);
+        if (!serverEntry)
+            serverEntry = loadBalanceSingleton.Select(request.type, realmId);
+
+        if (serverEntry && useAffinity)
+            affinitySingleton.Remember(request.type, realmId, request.requesterId, *serverEntry, now);
+
+        return serverEntry;
+    }
+    bool GeneralHandlers::MustWait(const LoginQueueSingleton& loginQueueSingleton, const AddressRequest& request, u8 realmId)
+    {
+        return request.type == AddressType::INSTANCE && request.sizeHint > 0 && loginQueueSingleton.IsQueueing(realmId);
+    }
+    bool GeneralHandlers::TryQueue(LoginQueueSingleton& loginQueueSingleton, const LoadBalanceSingleton& loadBalanceSingleton, const PlacementSingleton& placementSingleton, const std::shared_ptr<NetClient>& netClient, const AddressRequest& request, u8 realmId, const u8* cookie, size_t cookieSize, f32 now, AddressStatus& status, u32& position, u16& etaSeconds)
+    {
+        if (request.type != AddressType::INSTANCE || request.sizeHint == 0)
+            return false;
+
+        if (!loginQueueSingleton.CanWait(loadBalanceSingleton, placementSingleton, realmId, request.sizeHint))
+            return false;
+
+        bool didQueue = loginQueueSingleton.Enqueue(netClient, request.hasRequesterId, request.requesterId, realmId, request.sizeHint, cookie, cookieSize, now, position, etaSeconds);
+        status = didQueue ? AddressStatus::QUEUED : AddressStatus::BUSY;
+        return true;
+    }
+    void GeneralHandlers::FinalizeAddressBulk(std::shared_ptr<Bytebuffer>& buffer, size_t countOffset, u16 count)
+    {
+        u16 payloadSize = static_cast<u16>(buffer->writtenData - sizeof(PacketHeader));
+
+        buffer->Put<u16>(payloadSize, 2);
+        buffer->Put<u16>(count, countOffset);
+    }
     bool GeneralHandlers::HandleFullServerInfoUpdate(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
     {
         entt::registry* registry = ServiceLocator::GetRegistry();
         LoadBalanceSingleton& loadBalanceSingleton = registry->ctx<LoadBalanceSingleton>();
 
-        // Clear Cache
-        loadBalanceSingleton.Clear();
+        // Parsed whole before any of it is applied, a malformed list leaves the servers we know as they are
+        std::vector<ServerInformation> servers;
+        servers.reserve(packet->payload->GetReadSpace() / sizeof(ServerInformation));
 
         ServerInformation serverInformation;
         while (packet->payload->GetReadSpace())
@@ -111,36 +450,12 @@ namespace InternalSocket
             if (!packet->payload->GetU16(serverInformation.port))
                 return false;
 
-            if (serverInformation.type == AddressType::AUTH)
-            {
-                loadBalanceSingleton.Add<AddressType::AUTH>(serverInformation);
-            }
-            else if (serverInformation.type == AddressType::REALM)
-            {
-                loadBalanceSingleton.Add<AddressType::REALM>(serverInformation);
-            }
-            else if (serverInformation.type == AddressType::WORLD)
-            {
-                loadBalanceSingleton.Add<AddressType::WORLD>(serverInformation);
-            }
-            else if (serverInformation.type == AddressType::INSTANCE)
-            {
-                loadBalanceSingleton.Add<AddressType::INSTANCE>(serverInformation);
-            }
-            else if (serverInformation.type == AddressType::CHAT)
-            {
-                loadBalanceSingleton.Add<AddressType::CHAT>(serverInformation);
-            }
-            else if (serverInformation.type == AddressType::LOADBALANCE)
-            {
-                loadBalanceSingleton.Add<AddressType::LOADBALANCE>(serverInformation);
-            }
-            else if (serverInformation.type == AddressType::REGION)
-            {
-                loadBalanceSingleton.Add<AddressType::REGION>(serverInformation);
-            }
+            servers.push_back(serverInformation);
         }
 
+        // Servers still on the list keep their drain state and placement reservations, an operator's drain survives the upstream resending its list
+        loadBalanceSingleton.Reconcile(servers);
+
         return true;
     }
     bool GeneralHandlers::HandleServerInfoAdd(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
@@ -170,31 +485,31 @@ namespace InternalSocket
 
         if (serverInformation.type == AddressType::AUTH)
         {
-            loadBalanceSingleton.Add<AddressType::AUTH>(serverInformation);
+            loadBalanceSingleton.Add<AddressType::AUTH>(serverInformation, true);
         }
         else if (serverInformation.type == AddressType::REALM)
         {
-            loadBalanceSingleton.Add<AddressType::REALM>(serverInformation);
+            loadBalanceSingleton.Add<AddressType::REALM>(serverInformation, true);
         }
         else if (serverInformation.type == AddressType::WORLD)
         {
-            loadBalanceSingleton.Add<AddressType::WORLD>(serverInformation);
+            loadBalanceSingleton.Add<AddressType::WORLD>(serverInformation, true);
         }
         else if (serverInformation.type == AddressType::INSTANCE)
         {
-            loadBalanceSingleton.Add<AddressType::INSTANCE>(serverInformation);
+            loadBalanceSingleton.Add<AddressType::INSTANCE>(serverInformation, true);
         }
         else if (serverInformation.type == AddressType::CHAT)
         {
-            loadBalanceSingleton.Add<AddressType::CHAT>(serverInformation);
+            loadBalanceSingleton.Add<AddressType::CHAT>(serverInformation, true);
         }
         else if (serverInformation.type == AddressType::LOADBALANCE)
         {
-            loadBalanceSingleton.Add<AddressType::LOADBALANCE>(serverInformation);
+            loadBalanceSingleton.Add<AddressType::LOADBALANCE>(serverInformation, true);
         }
         else if (serverInformation.type == AddressType::REGION)
         {
-            loadBalanceSingleton.Add<AddressType::REGION>(serverInformation);
+            loadBalanceSingleton.Add<AddressType::REGION>(serverInformation, true);
         }
 
         return true;
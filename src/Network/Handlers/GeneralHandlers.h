@@ -1,19 +1,60 @@
 #pragma once
+#include <NovusTypes.h>
 #include <memory>
 
 class NetPacketHandler;
 class NetClient;
 struct NetPacket;
+class Bytebuffer;
+enum class AddressType : u8;
+enum class AddressStatus : u8;
+struct ServerEntry;
+struct LoadBalanceSingleton;
+struct ConnectionSingleton;
+struct ProximitySingleton;
+struct PlacementSingleton;
+struct AffinitySingleton;
+struct LoginQueueSingleton;
 namespace InternalSocket
 {
+    // The request prefix shared by MSG_REQUEST_ADDRESS and every MSG_REQUEST_ADDRESS_BULK entry
+    struct AddressRequest
+    {
+        AddressType type;
+        bool hasRequesterId = false;
+        u64 requesterId = 0;
+        u16 sizeHint = 0; // Only used by INSTANCE requests, 0 if the request has none
+        u8 realmId = 0;
+        bool hasRequesterAddress = false;
+        u32 requesterAddress = 0; // Network order
+    };
+
     class GeneralHandlers
     {
     public:
+        static constexpr u16 MAX_BULK_ADDRESS_REQUESTS = 1024;
+
         static void Setup(NetPacketHandler*);
         static bool HandleConnected(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
         static bool HandleRequestAddress(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
+        static bool HandleRequestAddressBulk(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
         static bool HandleFullServerInfoUpdate(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
         static bool HandleServerInfoAdd(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
         static bool HandleServerInfoRemove(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
+        static bool HandleSetServerDraining(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
+        static bool HandleReportServerFailure(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
+        static bool HandleInstanceComplete(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
+
+    private:
+        static bool ReadAddressRequest(std::shared_ptr<Bytebuffer>& payload, bool trustsRequesterIds, AddressRequest& request);
+        static bool TrustsRequesterIds(ConnectionSingleton& connectionSingleton, const std::shared_ptr<NetClient>& netClient);
+        // The connection's zone is looked up once per packet, requests relaying a requester address are placed by that address instead. INVALID_ZONE if the proximity policy is disabled
+        static u16 GetConnectionZone(ConnectionSingleton& connectionSingleton, ProximitySingleton& proximitySingleton, const std::shared_ptr<NetClient>& netClient);
+        static const ServerEntry* SelectServer(LoadBalanceSingleton& loadBalanceSingleton, ProximitySingleton& proximitySingleton, PlacementSingleton& placementSingleton, AffinitySingleton& affinitySingleton, const AddressRequest& request, u8 realmId, u16 connectionZone, f32 now);
+        // Sized instance requests wait in the realm's login queue while every instance server is full, and behind anyone already waiting
+        static bool MustWait(const LoginQueueSingleton& loginQueueSingleton, const AddressRequest& request, u8 realmId);
+        // Returns false if the request can't wait, status is then untouched. Otherwise it is QUEUED, or BUSY if the realm's queue is full
+        static bool TryQueue(LoginQueueSingleton& loginQueueSingleton, const LoadBalanceSingleton& loadBalanceSingleton, const PlacementSingleton& placementSingleton, const std::shared_ptr<NetClient>& netClient, const AddressRequest& request, u8 realmId, const u8* cookie, size_t cookieSize, f32 now, AddressStatus& status, u32& position, u16& etaSeconds);
+        static void FinalizeAddressBulk(std::shared_ptr<Bytebuffer>&, size_t countOffset, u16 count);
     };
 }
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include "HotRestart.h"
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#pragma pack(push, 1)
+struct HandoffHeader
+{
+    u32 magic;
+    u16 version;
+    u8 connectionStatus;
+    u32 unreadSize;
+    u32 snapshotSize;
+    u8 datagramKeySize;
+};
+#pragma pack(pop)
+
+static bool MakeAddress(const std::string& path, sockaddr_un& address)
+{
+    if (path.size() >= sizeof(address.sun_path))
+        return false;
+
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+HotRestart::~HotRestart()
+{
+    if (_peer >= 0)
+        close(_peer);
+
+    if (_listener >= 0)
+        close(_listener);
+}
+
+bool HotRestart::Receive(const std::string& path, Handoff& handoff)
+{
+    sockaddr_un address;
+    if (!MakeAddress(path, address))
+        return false;
+
+    i32 peer = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (peer < 0)
+        return false;
+
+    // A stale path left behind by a process which did not exit cleanly refuses the connection, we start from scratch then
+    if (connect(peer, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    {
+        close(peer);
+        return false;
+    }
+
+    // Covers the old process's whole handoff, which starts no earlier than our connect
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(TIMEOUT_MS + CONFIRM_MARGIN_MS);
+    SetTimeout(peer);
+
+    // The header and the socket arrive in a single message
+    HandoffHeader header;
+    iovec iov = { &header, sizeof(header) };
+
+    alignas(cmsghdr) u8 control[CMSG_SPACE(sizeof(i32))];
+    msghdr message = {};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t received = WaitFor(peer, POLLIN, deadline) ? recvmsg(peer, &message, MSG_WAITALL) : -1;
+    cmsghdr* controlMessage = CMSG_FIRSTHDR(&message);
+    if (received != sizeof(header) || !controlMessage || controlMessage->cmsg_type != SCM_RIGHTS || header.magic != MAGIC || header.version != VERSION)
+    {
+        if (controlMessage && controlMessage->cmsg_type == SCM_RIGHTS)
+        {
+            i32 socket = -1;
+            std::memcpy(&socket, CMSG_DATA(controlMessage), sizeof(socket));
+            close(socket);
+        }
+
+        close(peer);
+        return false;
+    }
+
+    std::memcpy(&handoff.socket, CMSG_DATA(controlMessage), sizeof(handoff.socket));
+    handoff.connectionStatus = header.connectionStatus;
+    handoff.unread.resize(header.unreadSize);
+    handoff.snapshot.resize(header.snapshotSize);
+    handoff.datagramKey.resize(header.datagramKeySize);
+
+    if (!ReadAll(peer, handoff.unread.data(), handoff.unread.size(), deadline) ||
+        !ReadAll(peer, handoff.snapshot.data(), handoff.snapshot.size(), deadline) ||
+        !ReadAll(peer, handoff.datagramKey.data(), handoff.datagramKey.size(), deadline))
+    {
+        close(handoff.socket);
+        handoff.socket = -1;
+        close(peer);
+        return false;
+    }
+
+    _peer = peer;
+    return true;
+}
+
+bool HotRestart::Acknowledge()
+{
+    if (_peer < 0)
+        return false;
+
+    // The old process decides before its deadline, which lies before ours as it accepted us before we could acknowledge
+    // A confirm can't arrive after we stopped waiting, and closing the peer makes any later confirm fail on the old process
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(TIMEOUT_MS + CONFIRM_MARGIN_MS);
+
+    u8 acknowledge = ACKNOWLEDGE;
+    u8 confirm = 0;
+    bool isConfirmed = WriteAll(_peer, &acknowledge, sizeof(acknowledge), deadline) &&
+                       ReadAll(_peer, &confirm, sizeof(confirm), deadline) && confirm == CONFIRM;
+
+    close(_peer);
+    _peer = -1;
+    return isConfirmed;
+}
+
+void HotRestart::Reject()
+{
+    if (_peer < 0)
+        return;
+
+    // Closing without acknowledging is the rejection
+    close(_peer);
+    _peer = -1;
+}
+
+bool HotRestart::Listen(const std::string& path)
+{
+    sockaddr_un address;
+    if (!MakeAddress(path, address))
+        return false;
+
+    _listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_listener < 0)
+        return false;
+
+    // The path belongs to the process we took over from or to one that is gone, either way it is ours now
+    unlink(path.c_str());
+
+    if (bind(_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(_listener, 1) < 0)
+    {
+        close(_listener);
+        _listener = -1;
+        return false;
+    }
+
+    fcntl(_listener, F_SETFL, fcntl(_listener, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+i32 HotRestart::Accept()
+{
+    if (_listener < 0)
+        return -1;
+
+    i32 peer = accept(_listener, nullptr, nullptr);
+    if (peer < 0)
+        return -1;
+
+    // Every step of the handoff polls against its deadline, a new process that stops reading can't stall our update past it
+    fcntl(peer, F_SETFL, fcntl(peer, F_GETFL, 0) | O_NONBLOCK);
+    return peer;
+}
+
+bool HotRestart::Send(i32 peer, const Handoff& handoff, Clock::time_point deadline)
+{
+    HandoffHeader header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.connectionStatus = handoff.connectionStatus;
+    header.unreadSize = static_cast<u32>(handoff.unread.size());
+    header.snapshotSize = static_cast<u32>(handoff.snapshot.size());
+    header.datagramKeySize = static_cast<u8>(handoff.datagramKey.size());
+
+    iovec iov = { &header, sizeof(header) };
+
+    alignas(cmsghdr) u8 control[CMSG_SPACE(sizeof(i32))] = {};
+    msghdr message = {};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    cmsghdr* controlMessage = CMSG_FIRSTHDR(&message);
+    controlMessage->cmsg_level = SOL_SOCKET;
+    controlMessage->cmsg_type = SCM_RIGHTS;
+    controlMessage->cmsg_len = CMSG_LEN(sizeof(i32));
+    std::memcpy(CMSG_DATA(controlMessage), &handoff.socket, sizeof(i32));
+
+    // The socket buffer is empty this early, the header goes out whole or not at all
+    if (!WaitFor(peer, POLLOUT, deadline) || sendmsg(peer, &message, MSG_NOSIGNAL) != sizeof(header))
+        return false;
+
+    return WriteAll(peer, handoff.unread.data(), handoff.unread.size(), deadline) &&
+           WriteAll(peer, handoff.snapshot.data(), handoff.snapshot.size(), deadline) &&
+           WriteAll(peer, handoff.datagramKey.data(), handoff.datagramKey.size(), deadline);
+}
+
+bool HotRestart::WaitForAcknowledge(i32 peer, Clock::time_point deadline)
+{
+    u8 acknowledge = 0;
+    return ReadAll(peer, &acknowledge, sizeof(acknowledge), deadline) && acknowledge == ACKNOWLEDGE;
+}
+
+bool HotRestart::Confirm(i32 peer, Clock::time_point deadline)
+{
+    // WriteAll never writes past the deadline, the new process is still waiting for as long as this can succeed
+    u8 confirm = CONFIRM;
+    return WriteAll(peer, &confirm, sizeof(confirm), deadline);
+}
+
+void HotRestart::Abort(i32 peer)
+{
+    shutdown(peer, SHUT_RDWR);
+    close(peer);
+}
+
+bool HotRestart::WriteAll(i32 socket, const void* data, size_t size, Clock::time_point deadline)
+{
+    const u8* bytes = static_cast<const u8*>(data);
+    while (size > 0)
+    {
+        if (!WaitFor(socket, POLLOUT, deadline))
+            return false;
+
+        ssize_t written = send(socket, bytes, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+            continue;
+
+        if (written <= 0)
+            return false;
+
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+
+    return true;
+}
+
+bool HotRestart::ReadAll(i32 socket, void* data, size_t size, Clock::time_point deadline)
+{
+    u8* bytes = static_cast<u8*>(data);
+    while (size > 0)
+    {
+        if (!WaitFor(socket, POLLIN, deadline))
+            return false;
+
+        ssize_t received = recv(socket, bytes, size, MSG_DONTWAIT);
+        if (received < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+            continue;
+
+        if (received <= 0)
+            return false;
+
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+
+    return true;
+}
+
+bool HotRestart::WaitFor(i32 socket, i16 events, Clock::time_point deadline)
+{
+    while (true)
+    {
+        i64 remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (remaining <= 0)
+            return false;
+
+        pollfd pollFd = { socket, events, 0 };
+        i32 result = poll(&pollFd, 1, static_cast<i32>(remaining));
+        if (result < 0 && errno == EINTR)
+            continue;
+
+        // Errors and hangups are left for the following send or recv to report
+        return result > 0;
+    }
+}
+
+void HotRestart::SetTimeout(i32 socket)
+{
+    constexpr i32 timeoutMs = TIMEOUT_MS + CONFIRM_MARGIN_MS;
+
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+#endif // _WIN32
@@ -0,0 +1,90 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#ifndef _WIN32
+#include <NovusTypes.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/*
+    Hands the upstream connection from a running load balancer to its replacement, so an upgrade neither drops the link nor has to log in again.
+    Every process started with a handoff path first asks whoever listens on it for the connection, then listens on it itself for the next upgrade.
+    The connected socket travels as SCM_RIGHTS ancillary data over the Unix domain socket, followed by the bytes read from it but not framed yet, a snapshot of the server pools and the datagram key.
+    The new process acknowledges what it received and only starts once the old process confirms that acknowledge, the old process exits once its confirm is written.
+    If the exchange does not complete within TIMEOUT_MS the old process shuts the peer down and adopts the socket again, a new process that saw no confirm then closes its copy.
+    The old process writes its confirm before its own deadline and the new process waits CONFIRM_MARGIN_MS past that, so a confirm is never sent without being read.
+*/
+class HotRestart
+{
+public:
+    static constexpr u32 MAGIC = 0x5248434E; // NCHR
+    static constexpr u16 VERSION = 3;
+    static constexpr i32 TIMEOUT_MS = 1000; // The whole handoff on the old process, its update loop is stalled for as long
+    static constexpr i32 CONFIRM_MARGIN_MS = 1000;
+    static constexpr u8 ACKNOWLEDGE = 1;
+    static constexpr u8 CONFIRM = 2;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Handoff
+    {
+        i32 socket = -1;
+        u8 connectionStatus = 0;
+        std::vector<u8> unread;
+        std::vector<u8> snapshot;
+        std::vector<u8> datagramKey; // Empty if we never logged in, the new process has no SRP session of its own to derive it from
+    };
+
+    ~HotRestart();
+
+    // New process. Returns false if nobody hands off on the path, which is the normal case for the first process
+    bool Receive(const std::string& path, Handoff& handoff);
+    // Tells the old process we have the connection, returns true only once it confirms it let go. Without a confirm the old process keeps the connection
+    bool Acknowledge();
+    // The handoff could not be applied, the old process keeps its connection
+    void Reject();
+
+    // Old process. Listens without blocking, Accept is polled once per tick and returns -1 until a new process connects
+    bool Listen(const std::string& path);
+    bool IsListening() const { return _listener >= 0; }
+    i32 Accept();
+    static bool Send(i32 peer, const Handoff& handoff, Clock::time_point deadline);
+    static bool WaitForAcknowledge(i32 peer, Clock::time_point deadline);
+    // Once this returns true the connection belongs to the new process
+    static bool Confirm(i32 peer, Clock::time_point deadline);
+    // The handoff failed, the new process stops waiting for our confirm right away
+    static void Abort(i32 peer);
+
+private:
+    static bool WriteAll(i32 socket, const void* data, size_t size, Clock::time_point deadline);
+    static bool ReadAll(i32 socket, void* data, size_t size, Clock::time_point deadline);
+    static bool WaitFor(i32 socket, i16 events, Clock::time_point deadline);
+    static void SetTimeout(i32 socket);
+
+private:
+    i32 _listener = -1;
+    i32 _peer = -1; // Our connection to the old process while a handoff is being received
+};
+#endif // _WIN32
@@ -0,0 +1,174 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <Networking/NetStructures.h>
+#include <Networking/NetPacket.h>
+#include <Utils/ByteBuffer.h>
+#include "../Utils/SPSCRingBuffer.h"
+
+enum class PacketLane : u8
+{
+    CONTROL, // Authentication and topology updates, these change what the data lane should be answered with
+    DATA, // Address requests
+    COUNT
+};
+
+// A lane slot owns its packet and payload storage and reuses both for every packet framed into it, once each slot has seen its largest payload framing allocates nothing
+struct QueuedPacket
+{
+    NetPacket packet;
+    std::vector<u8> storage;
+    std::shared_ptr<Bytebuffer> payload = nullptr; // Wraps storage, recreated only when storage grows
+    u64 enqueuedAt = 0; // Steady clock nanoseconds, used for the lane's wait time
+};
+
+using PacketQueue = SPSCRingBuffer<QueuedPacket, 1024>;
+
+struct PacketLaneMetrics
+{
+    u64 numDispatched = 0;
+    size_t peakDepth = 0;
+    f64 totalWait = 0.0;
+    f64 maxWait = 0.0;
+    f64 lastWait = 0.0;
+};
+
+/*
+    Framed packets waiting to be dispatched, split into lanes by opcode.
+    Dispatch drains the control lane before the data lane so a server removal never waits behind requests that would be routed to it.
+    Packets keep their stream order within a lane.
+    Packets are framed straight into their lane slot with TryReserve and Commit, and handled in place between Front and Pop.
+*/
+class PacketLanes
+{
+public:
+    static constexpr size_t NUM_LANES = static_cast<size_t>(PacketLane::COUNT);
+
+    static PacketLane Classify(Opcode opcode)
+    {
+        switch (opcode)
+        {
+            case Opcode::MSG_REQUEST_ADDRESS:
+            case Opcode::MSG_REQUEST_ADDRESS_BULK:
+                return PacketLane::DATA;
+
+            default:
+                return PacketLane::CONTROL;
+        }
+    }
+
+    static u64 Now()
+    {
+        return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Handlers take a std::shared_ptr, aliasing an empty one hands them the slot without allocating a control block
+    // The handle does not own the slot, it must not outlive the handler call
+    static std::shared_ptr<NetPacket> MakeHandle(NetPacket* packet)
+    {
+        return std::shared_ptr<NetPacket>(std::shared_ptr<NetPacket>(), packet);
+    }
+
+    bool IsFull(PacketLane lane) const { return _queues[static_cast<size_t>(lane)].IsFull(); }
+
+    // Returns nullptr if the lane is full. The packet's payload holds payloadSize bytes to be filled in before Commit, it is nullptr for an empty payload
+    NetPacket* TryReserve(PacketLane lane, u16 payloadSize)
+    {
+        QueuedPacket* queuedPacket = _queues[static_cast<size_t>(lane)].TryReserve();
+        if (!queuedPacket)
+            return nullptr;
+
+        if (queuedPacket->storage.size() < payloadSize)
+        {
+            queuedPacket->storage.resize(std::max<size_t>(payloadSize, MIN_PAYLOAD_STORAGE));
+            queuedPacket->payload = std::make_shared<Bytebuffer>(queuedPacket->storage.data(), queuedPacket->storage.size());
+        }
+
+        if (payloadSize > 0)
+        {
+            Bytebuffer* payload = queuedPacket->payload.get();
+            payload->Reset();
+            payload->size = payloadSize;
+            payload->writtenData = payloadSize;
+            queuedPacket->packet.payload = queuedPacket->payload;
+        }
+        else
+        {
+            queuedPacket->packet.payload = nullptr;
+        }
+
+        return &queuedPacket->packet;
+    }
+    void Commit(PacketLane lane)
+    {
+        size_t index = static_cast<size_t>(lane);
+
+        _queues[index].TryReserve()->enqueuedAt = Now();
+        _queues[index].Commit();
+        _metrics[index].peakDepth = std::max(_metrics[index].peakDepth, _queues[index].Size());
+    }
+
+    // Takes from the highest priority lane which has anything queued, the packet stays valid until Pop is called for its lane
+    NetPacket* Front(PacketLane& lane)
+    {
+        for (size_t i = 0; i < NUM_LANES; i++)
+        {
+            QueuedPacket* queuedPacket = _queues[i].Front();
+            if (!queuedPacket)
+                continue;
+
+            f64 wait = static_cast<f64>(Now() - queuedPacket->enqueuedAt) / 1e9;
+
+            PacketLaneMetrics& metrics = _metrics[i];
+            metrics.numDispatched++;
+            metrics.totalWait += wait;
+            metrics.maxWait = std::max(metrics.maxWait, wait);
+            metrics.lastWait = wait;
+
+            lane = static_cast<PacketLane>(i);
+            return &queuedPacket->packet;
+        }
+
+        return nullptr;
+    }
+    void Pop(PacketLane lane)
+    {
+        _queues[static_cast<size_t>(lane)].Pop();
+    }
+
+    size_t GetDepth(PacketLane lane) const { return _queues[static_cast<size_t>(lane)].Size(); }
+    const PacketLaneMetrics& GetMetrics(PacketLane lane) const { return _metrics[static_cast<size_t>(lane)]; }
+
+private:
+    static constexpr size_t MIN_PAYLOAD_STORAGE = 256; // Most address requests fit, so a slot rarely has to grow twice
+
+    std::array<PacketQueue, NUM_LANES> _queues;
+    std::array<PacketLaneMetrics, NUM_LANES> _metrics;
+};
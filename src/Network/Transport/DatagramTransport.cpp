@@ -0,0 +1,72 @@
+#include "DatagramTransport.h"
+#ifndef _WIN32
+#include <Utils/ByteBuffer.h>
+#include <Networking/NetClient.h>
+#include <Networking/NetStructures.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include "../UdpEndpoint.h"
+#include "../DatagramProtocol.h"
+
+DatagramTransport::DatagramTransport(UdpEndpoint& endpoint, const Sha256::Digest& key, const sockaddr_in& address)
+    : NetTransport(std::make_shared<NetClient>()), _endpoint(endpoint), _key(key), _address(address)
+{
+    // The client never opens its socket, it carries the ConnectionStatus the address request handlers check
+    _netClient->Init(NetSocket::Mode::TCP);
+    _netClient->SetConnectionStatus(ConnectionStatus::CONNECTED);
+
+    char addressString[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &address.sin_addr, addressString, sizeof(addressString));
+
+    _connectionInfo.ipAddr = address.sin_addr.s_addr;
+    _connectionInfo.ipAddrStr = addressString;
+    _connectionInfo.port = ntohs(address.sin_port);
+}
+
+void DatagramTransport::Send(std::shared_ptr<Bytebuffer> buffer)
+{
+    using namespace DatagramProtocol;
+
+    if (!_isConnected)
+        return;
+
+    const u8* data = buffer->GetDataPointer();
+    size_t size = buffer->writtenData;
+    u32 timestamp = static_cast<u32>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+    while (size >= sizeof(PacketHeader))
+    {
+        PacketHeader header;
+        std::memcpy(&header, data, sizeof(header));
+
+        size_t packetSize = sizeof(PacketHeader) + header.size;
+        if (packetSize > size)
+            return;
+
+        // Anything but an answer to a single request can't be told apart from the request id, and nothing else should end up here
+        const u8* payload = data + sizeof(PacketHeader);
+        if (header.opcode == Opcode::SMSG_SEND_ADDRESS && header.size >= sizeof(u32) && OVERHEAD + header.size - sizeof(u32) <= MAX_DATAGRAM_SIZE)
+        {
+            size_t bodySize = header.size - sizeof(u32);
+
+            DatagramHeader datagramHeader;
+            datagramHeader.type = DatagramType::SEND_ADDRESS;
+            datagramHeader.timestamp = timestamp;
+            datagramHeader.sequence = _sequence++;
+            std::memcpy(&datagramHeader.requestId, payload + bodySize, sizeof(u32));
+
+            u8* datagram = _endpoint.Prepare();
+            std::memcpy(datagram, &datagramHeader, sizeof(datagramHeader));
+            std::memcpy(datagram + sizeof(datagramHeader), payload, bodySize);
+
+            size_t signedSize = sizeof(datagramHeader) + bodySize;
+            Sign(_key, _address.sin_addr.s_addr, _address.sin_port, datagram, signedSize);
+            _endpoint.Commit(_address, signedSize + TAG_SIZE);
+        }
+
+        data += packetSize;
+        size -= packetSize;
+    }
+}
+#endif // _WIN32
@@ -0,0 +1,61 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#ifndef _WIN32
+#include <NovusTypes.h>
+#include <netinet/in.h>
+#include "NetTransport.h"
+#include "../../Utils/Sha256.h"
+
+class UdpEndpoint;
+
+/*
+    One requester on the UDP endpoint, so handlers, admission and the login queue see it like any other connection.
+    DatagramSystem hands its requests to the handlers itself, Send turns each SMSG_SEND_ADDRESS they answer with into a signed datagram back to the requester.
+    The request id travels as the request's cookie, which every SMSG_SEND_ADDRESS echoes at its end.
+*/
+class DatagramTransport : public NetTransport
+{
+public:
+    DatagramTransport(UdpEndpoint& endpoint, const Sha256::Digest& key, const sockaddr_in& address);
+
+    // Nothing is ever framed from a datagram transport
+    bool Read() override { return false; }
+    std::shared_ptr<Bytebuffer> GetReadBuffer() override { return nullptr; }
+    void Send(std::shared_ptr<Bytebuffer> buffer) override;
+
+    bool IsConnected() override { return _isConnected; }
+    void Close() override { _isConnected = false; }
+    const NetSocket::ConnectionInfo& GetConnectionInfo() override { return _connectionInfo; }
+
+private:
+    UdpEndpoint& _endpoint;
+    const Sha256::Digest& _key; // AuthenticationSingleton's, a new session key applies to responses still queued
+    sockaddr_in _address;
+    u32 _sequence = 0; // Counter for our responses, see DatagramHeader
+
+    bool _isConnected = true;
+    NetSocket::ConnectionInfo _connectionInfo;
+};
+#endif // _WIN32
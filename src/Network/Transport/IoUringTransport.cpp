@@ -0,0 +1,450 @@
+#include "IoUringTransport.h"
+#ifdef NC_IO_URING
+#include <Utils/ByteBuffer.h>
+#include <Utils/DebugHandler.h>
+#include <Networking/NetClient.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+static constexpr i32 RECEIVE_BUFFER_GROUP = 0;
+
+IoUringTransport::IoUringTransport()
+    : NetTransport(std::make_shared<NetClient>())
+{
+    // The NetClient never connects, it only carries the ConnectionStatus for the packet handlers
+    _netClient->Init(NetSocket::Mode::TCP);
+
+    _readStorage.resize(READ_BUFFER_SIZE);
+    _readBuffer = std::make_shared<Bytebuffer>(_readStorage.data(), _readStorage.size());
+}
+
+IoUringTransport::~IoUringTransport()
+{
+    Close();
+
+    if (_receiveBufferRing)
+        io_uring_free_buf_ring(&_ring, _receiveBufferRing, NUM_RECEIVE_BUFFERS, RECEIVE_BUFFER_GROUP);
+
+    if (_isRingInitialized)
+        io_uring_queue_exit(&_ring);
+}
+
+bool IoUringTransport::Init()
+{
+    if (io_uring_queue_init(QUEUE_DEPTH, &_ring, 0) < 0)
+        return false;
+
+    _isRingInitialized = true;
+
+    i32 result = 0;
+    _receiveBufferRing = io_uring_setup_buf_ring(&_ring, NUM_RECEIVE_BUFFERS, RECEIVE_BUFFER_GROUP, 0, &result);
+    if (!_receiveBufferRing)
+        return false;
+
+    _receiveBuffers.resize(static_cast<size_t>(NUM_RECEIVE_BUFFERS) * RECEIVE_BUFFER_SIZE);
+    for (u16 i = 0; i < NUM_RECEIVE_BUFFERS; i++)
+    {
+        io_uring_buf_ring_add(_receiveBufferRing, &_receiveBuffers[static_cast<size_t>(i) * RECEIVE_BUFFER_SIZE], RECEIVE_BUFFER_SIZE, i, io_uring_buf_ring_mask(NUM_RECEIVE_BUFFERS), i);
+    }
+    io_uring_buf_ring_advance(_receiveBufferRing, NUM_RECEIVE_BUFFERS);
+
+    _sendSlots.resize(QUEUE_DEPTH);
+    _freeSendSlots.reserve(QUEUE_DEPTH);
+    for (u32 i = QUEUE_DEPTH; i > 0; i--)
+    {
+        _freeSendSlots.push_back(i - 1);
+    }
+
+    return true;
+}
+
+bool IoUringTransport::Connect(const std::string& address, u16 port)
+{
+    _socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (_socket < 0)
+        return false;
+
+    // Match the options EngineLoop sets on the regular socket
+    i32 noDelay = 1;
+    i32 bufferSize = 8192;
+    setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    setsockopt(_socket, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+    setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    sockaddr_in socketAddress = {};
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1)
+        return false;
+
+    _connectionInfo.ipAddr = socketAddress.sin_addr.s_addr;
+    _connectionInfo.ipAddrStr = address;
+    _connectionInfo.port = port;
+
+    if (connect(_socket, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) < 0)
+        return false;
+
+    _isConnected = true;
+    ArmReceive();
+    io_uring_submit(&_ring);
+    return true;
+}
+
+bool IoUringTransport::Adopt(i32 socket, const std::vector<u8>& unread)
+{
+    Close();
+
+    // The previous owner may have made it non-blocking, sends on it would then fail with EAGAIN instead of waiting in the ring
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) & ~O_NONBLOCK);
+
+    _socket = socket;
+    UpdateConnectionInfo();
+
+    _readBuffer->Reset();
+    _overflow.clear();
+    _isOverflowFull = false;
+    AppendReceived(unread.data(), unread.size());
+
+    _isConnected = true;
+    if (!_isOverflowFull)
+        ArmReceive();
+
+    io_uring_submit(&_ring);
+    return true;
+}
+
+i32 IoUringTransport::Detach(std::vector<u8>& unread)
+{
+    if (_socket < 0 || _pendingSendBytes > 0)
+        return -1;
+
+    // Stop the posted receive and wait for it to finish, whatever it delivers before that is part of what the next owner has to frame
+    if (_isReceiveArmed)
+    {
+        if (!CancelReceive())
+            return -1;
+
+        io_uring_submit(&_ring);
+        _numQueued = 0;
+
+        io_uring_cqe* cqe = nullptr;
+        while (_isReceiveArmed && io_uring_wait_cqe(&_ring, &cqe) == 0)
+        {
+            Operation operation = static_cast<Operation>(io_uring_cqe_get_data64(cqe) >> 32);
+            if (operation == Operation::RECEIVE)
+                HandleReceive(cqe);
+            else if (operation == Operation::SEND)
+                HandleSend(cqe);
+
+            io_uring_cqe_seen(&_ring, cqe);
+        }
+    }
+
+    unread.assign(_readBuffer->GetReadPointer(), _readBuffer->GetReadPointer() + _readBuffer->GetActiveSize());
+    unread.insert(unread.end(), _overflow.begin(), _overflow.end());
+    _readBuffer->Reset();
+    _overflow.clear();
+    _isOverflowFull = false;
+
+    i32 socket = _socket;
+    _socket = -1;
+    _isConnected = false;
+    return socket;
+}
+
+bool IoUringTransport::Read()
+{
+    // Data left over from the previous tick goes first so the stream stays in order
+    if (!_overflow.empty())
+    {
+        std::vector<u8> overflow;
+        overflow.swap(_overflow);
+        _isOverflowFull = false;
+        AppendReceived(overflow.data(), overflow.size());
+    }
+
+    io_uring_cqe* cqe = nullptr;
+    while (io_uring_peek_cqe(&_ring, &cqe) == 0)
+    {
+        Operation operation = static_cast<Operation>(io_uring_cqe_get_data64(cqe) >> 32);
+        if (operation == Operation::RECEIVE)
+        {
+            HandleReceive(cqe);
+        }
+        else if (operation == Operation::SEND)
+        {
+            HandleSend(cqe);
+        }
+
+        io_uring_cqe_seen(&_ring, cqe);
+    }
+
+    // Re-arm the receive if the kernel terminated the multishot, and push out resubmitted partial sends and started parked ones
+    if (_isConnected && !_isReceiveArmed && !_isReadPaused && !_isOverflowFull)
+        ArmReceive();
+
+    io_uring_submit(&_ring);
+    return _readBuffer->GetActiveSize() > 0;
+}
+
+void IoUringTransport::Send(std::shared_ptr<Bytebuffer> buffer)
+{
+    if (!_isConnected)
+        return;
+
+    // Once anything is parked everything after it has to be too, or it would overtake it on the stream
+    if (_freeSendSlots.empty() || !_parkedSends.empty())
+    {
+        if (_parkedSends.size() >= MAX_PARKED_SENDS)
+        {
+            DebugHandler::PrintWarning("[Network/IoUring]: Send queue is full, closing connection");
+            Close();
+            return;
+        }
+
+        _pendingSendBytes += buffer->writtenData;
+        _parkedSends.push_back(std::move(buffer));
+        return;
+    }
+
+    _pendingSendBytes += buffer->writtenData;
+    StartSend(std::move(buffer));
+}
+
+void IoUringTransport::SetReadPaused(bool paused)
+{
+    if (_isReadPaused == paused)
+        return;
+
+    _isReadPaused = paused;
+    if (!_isConnected)
+        return;
+
+    if (paused)
+    {
+        // Cancel the posted receive so the kernel's receive window fills up and the upstream slows down
+        if (_isReceiveArmed && !CancelReceive())
+            return;
+    }
+    else if (!_isReceiveArmed && !_isOverflowFull)
+    {
+        ArmReceive();
+    }
+
+    io_uring_submit(&_ring);
+    _numQueued = 0;
+}
+
+void IoUringTransport::Flush()
+{
+    if (_numQueued == 0)
+        return;
+
+    io_uring_submit(&_ring);
+    _numQueued = 0;
+}
+
+void IoUringTransport::Close()
+{
+    if (_socket < 0)
+        return;
+
+    // The posted receive holds its own reference to the socket, closing our descriptor alone would neither end it nor send the peer a FIN
+    // Shutting down first does both, the receive and any sends still in flight complete with errors the next time completions are reaped
+    shutdown(_socket, SHUT_RDWR);
+    close(_socket);
+    _socket = -1;
+    _isConnected = false;
+    _pendingSendBytes = 0;
+    _parkedSends.clear();
+}
+
+io_uring_sqe* IoUringTransport::GetSqe()
+{
+    io_uring_sqe* sqe = io_uring_get_sqe(&_ring);
+    if (!sqe)
+    {
+        // The submission queue is full, submit what we have and try again
+        io_uring_submit(&_ring);
+        _numQueued = 0;
+        sqe = io_uring_get_sqe(&_ring);
+    }
+
+    return sqe;
+}
+
+void IoUringTransport::ArmReceive()
+{
+    io_uring_sqe* sqe = GetSqe();
+    if (!sqe)
+        return;
+
+    io_uring_prep_recv_multishot(sqe, _socket, nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECEIVE_BUFFER_GROUP;
+    io_uring_sqe_set_data64(sqe, EncodeUserData(Operation::RECEIVE, 0));
+
+    _isReceiveArmed = true;
+}
+
+bool IoUringTransport::CancelReceive()
+{
+    io_uring_sqe* sqe = GetSqe();
+    if (!sqe)
+        return false;
+
+    io_uring_prep_cancel64(sqe, EncodeUserData(Operation::RECEIVE, 0), 0);
+    io_uring_sqe_set_data64(sqe, EncodeUserData(Operation::CANCEL, 0));
+    return true;
+}
+
+void IoUringTransport::StartSend(std::shared_ptr<Bytebuffer> buffer)
+{
+    u32 slot = _freeSendSlots.back();
+    _freeSendSlots.pop_back();
+
+    _sendSlots[slot].buffer = std::move(buffer);
+    _sendSlots[slot].offset = 0;
+    QueueSend(slot);
+}
+
+void IoUringTransport::QueueSend(u32 slot)
+{
+    io_uring_sqe* sqe = GetSqe();
+    if (!sqe)
+    {
+        Close();
+        return;
+    }
+
+    PendingSend& pendingSend = _sendSlots[slot];
+    const u8* data = pendingSend.buffer->GetDataPointer() + pendingSend.offset;
+    size_t size = pendingSend.buffer->writtenData - pendingSend.offset;
+
+    io_uring_prep_send(sqe, _socket, data, size, MSG_NOSIGNAL);
+    io_uring_sqe_set_data64(sqe, EncodeUserData(Operation::SEND, slot));
+    _numQueued++;
+}
+
+void IoUringTransport::HandleReceive(io_uring_cqe* cqe)
+{
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+        _isReceiveArmed = false;
+
+    if (cqe->res == -ECANCELED)
+    {
+        // Reads were paused, the receive is re-armed when they resume
+        return;
+    }
+
+    if (cqe->res == -ENOBUFS)
+    {
+        // We ran out of provided buffers, they are returned below as we consume them and the receive is re-armed
+        return;
+    }
+
+    if (cqe->res <= 0)
+    {
+        // 0 means the peer closed the connection
+        _isConnected = false;
+        return;
+    }
+
+    if (cqe->flags & IORING_CQE_F_BUFFER)
+    {
+        u16 bufferId = static_cast<u16>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        AppendReceived(&_receiveBuffers[static_cast<size_t>(bufferId) * RECEIVE_BUFFER_SIZE], static_cast<size_t>(cqe->res));
+        ReturnReceiveBuffer(bufferId);
+    }
+}
+
+void IoUringTransport::HandleSend(io_uring_cqe* cqe)
+{
+    u32 slot = static_cast<u32>(io_uring_cqe_get_data64(cqe) & 0xFFFFFFFF);
+    PendingSend& pendingSend = _sendSlots[slot];
+
+    if (cqe->res < 0)
+    {
+        _isConnected = false;
+    }
+    else if (_isConnected)
+    {
+        // TCP may accept only part of the buffer, queue the remainder
+        pendingSend.offset += static_cast<size_t>(cqe->res);
+        _pendingSendBytes -= std::min(_pendingSendBytes, static_cast<size_t>(cqe->res));
+        if (pendingSend.offset < pendingSend.buffer->writtenData)
+        {
+            QueueSend(slot);
+            return;
+        }
+    }
+
+    pendingSend.buffer = nullptr;
+    _freeSendSlots.push_back(slot);
+
+    // The freed slot goes to the oldest parked send, it is submitted along with the next Read or Flush
+    if (_isConnected && !_parkedSends.empty())
+    {
+        std::shared_ptr<Bytebuffer> buffer = std::move(_parkedSends.front());
+        _parkedSends.pop_front();
+        StartSend(std::move(buffer));
+    }
+}
+
+void IoUringTransport::ReturnReceiveBuffer(u16 bufferId)
+{
+    io_uring_buf_ring_add(_receiveBufferRing, &_receiveBuffers[static_cast<size_t>(bufferId) * RECEIVE_BUFFER_SIZE], RECEIVE_BUFFER_SIZE, bufferId, io_uring_buf_ring_mask(NUM_RECEIVE_BUFFERS), 0);
+    io_uring_buf_ring_advance(_receiveBufferRing, 1);
+}
+
+void IoUringTransport::UpdateConnectionInfo()
+{
+    sockaddr_in peerAddress = {};
+    socklen_t peerAddressSize = sizeof(peerAddress);
+    if (getpeername(_socket, reinterpret_cast<sockaddr*>(&peerAddress), &peerAddressSize) != 0)
+        return;
+
+    char addressString[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &peerAddress.sin_addr, addressString, sizeof(addressString));
+
+    _connectionInfo.ipAddr = peerAddress.sin_addr.s_addr;
+    _connectionInfo.ipAddrStr = addressString;
+    _connectionInfo.port = ntohs(peerAddress.sin_port);
+}
+
+void IoUringTransport::AppendReceived(const u8* data, size_t size)
+{
+    // Anything that does not fit waits in the overflow until framing has consumed the read buffer
+    if (_overflow.empty())
+    {
+        if (_readBuffer->GetActiveSize() == 0)
+            _readBuffer->Reset();
+        else if (_readBuffer->GetSpace() < size)
+            _readBuffer->Normalize();
+
+        size_t toCopy = std::min(size, _readBuffer->GetSpace());
+        _readBuffer->PutBytes(data, toCopy);
+
+        data += toCopy;
+        size -= toCopy;
+    }
+
+    if (size == 0)
+        return;
+
+    _overflow.insert(_overflow.end(), data, data + size);
+
+    // While framing is paused nothing drains the overflow, stop receiving until it does and let the kernel's window push back on the upstream
+    if (!_isOverflowFull && _overflow.size() >= MAX_OVERFLOW_SIZE)
+    {
+        _isOverflowFull = true;
+        if (_isReceiveArmed)
+            CancelReceive();
+    }
+}
+#endif // NC_IO_URING
@@ -0,0 +1,120 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#ifdef NC_IO_URING
+#include <NovusTypes.h>
+#include <deque>
+#include <vector>
+#include <liburing.h>
+#include "NetTransport.h"
+
+/*
+    Linux io_uring backend for the upstream connection.
+    A multishot receive stays posted on the socket and completes into a ring of provided buffers, sends are queued during the tick and submitted together in Flush.
+    Sends beyond QUEUE_DEPTH in flight wait in order for a slot to free up, received data beyond what framing has room for waits in an overflow with the receive cancelled while it is full.
+*/
+class IoUringTransport : public NetTransport
+{
+public:
+    static constexpr u32 QUEUE_DEPTH = 256;
+    static constexpr u32 NUM_RECEIVE_BUFFERS = 64;
+    static constexpr u32 RECEIVE_BUFFER_SIZE = 4096;
+    static constexpr size_t READ_BUFFER_SIZE = 65536;
+    static constexpr size_t MAX_PARKED_SENDS = 1024; // The connection is closed beyond this, OutboundQueue pauses reads long before
+    static constexpr size_t MAX_OVERFLOW_SIZE = 4 * READ_BUFFER_SIZE; // Exceeded by at most what was already received when the receive was cancelled
+
+    IoUringTransport();
+    ~IoUringTransport();
+
+    // Returns false if io_uring or provided buffer rings are not supported by the kernel, the caller should fall back to SocketTransport
+    bool Init();
+    bool Connect(const std::string& address, u16 port);
+    // Takes over a connected socket along with the bytes its previous owner read but never framed
+    bool Adopt(i32 socket, const std::vector<u8>& unread);
+
+    bool Read() override;
+    std::shared_ptr<Bytebuffer> GetReadBuffer() override { return _readBuffer; }
+    void Send(std::shared_ptr<Bytebuffer> buffer) override;
+    void Flush() override;
+    size_t GetPendingSendBytes() override { return _pendingSendBytes; }
+    void SetReadPaused(bool paused) override;
+    i32 Detach(std::vector<u8>& unread) override;
+    bool CanDetach() override { return _socket >= 0; }
+
+    bool IsConnected() override { return _isConnected; }
+    void Close() override;
+    const NetSocket::ConnectionInfo& GetConnectionInfo() override { return _connectionInfo; }
+
+private:
+    enum class Operation : u64
+    {
+        RECEIVE = 1,
+        SEND = 2,
+        CANCEL = 3
+    };
+
+    struct PendingSend
+    {
+        std::shared_ptr<Bytebuffer> buffer = nullptr;
+        size_t offset = 0;
+    };
+
+    static u64 EncodeUserData(Operation operation, u32 index) { return (static_cast<u64>(operation) << 32) | index; }
+
+    io_uring_sqe* GetSqe();
+    void ArmReceive();
+    bool CancelReceive();
+    void StartSend(std::shared_ptr<Bytebuffer> buffer);
+    void QueueSend(u32 slot);
+    void HandleReceive(io_uring_cqe* cqe);
+    void HandleSend(io_uring_cqe* cqe);
+    void ReturnReceiveBuffer(u16 bufferId);
+    void AppendReceived(const u8* data, size_t size);
+    void UpdateConnectionInfo();
+
+private:
+    io_uring _ring;
+    bool _isRingInitialized = false;
+
+    io_uring_buf_ring* _receiveBufferRing = nullptr;
+    std::vector<u8> _receiveBuffers;
+
+    i32 _socket = -1;
+    bool _isConnected = false;
+    bool _isReceiveArmed = false;
+    bool _isReadPaused = false;
+    NetSocket::ConnectionInfo _connectionInfo;
+
+    std::vector<u8> _readStorage;
+    std::shared_ptr<Bytebuffer> _readBuffer;
+    std::vector<u8> _overflow; // Received data which did not fit in the read buffer yet
+    bool _isOverflowFull = false; // The receive stays cancelled until framing has drained the overflow below MAX_OVERFLOW_SIZE
+
+    std::vector<PendingSend> _sendSlots;
+    std::vector<u32> _freeSendSlots;
+    std::deque<std::shared_ptr<Bytebuffer>> _parkedSends; // Waiting for a free send slot, started in order as HandleSend frees them
+    u32 _numQueued = 0;
+    size_t _pendingSendBytes = 0; // Bytes in the send slots and parked sends the kernel has not accepted yet
+};
+#endif // NC_IO_URING
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "MemoryTransport.h"
+#include <Utils/ByteBuffer.h>
+#include <Networking/NetClient.h>
+
+MemoryTransport::MemoryTransport(bool discardOutbound)
+    : NetTransport(std::make_shared<NetClient>()), _discardOutbound(discardOutbound)
+{
+    // The client never connects, it exists so handlers have something to check the ConnectionStatus of
+    _netClient->Init(NetSocket::Mode::TCP);
+
+    _connectionInfo.ipAddr = 0;
+    _connectionInfo.ipAddrStr = "memory";
+    _connectionInfo.port = 0;
+
+    _readStorage.resize(READ_BUFFER_SIZE);
+    _readBuffer = std::make_shared<Bytebuffer>(_readStorage.data(), _readStorage.size());
+}
+
+bool MemoryTransport::Read()
+{
+    if (HasInbound())
+    {
+        // Make room for as much of the inbound data as possible, framing only normalizes on partial packets
+        if (_readBuffer->GetActiveSize() == 0)
+            _readBuffer->Reset();
+
+        size_t size = std::min(_inbound.size() - _inboundReadOffset, _readBuffer->GetSpace());
+        _readBuffer->PutBytes(&_inbound[_inboundReadOffset], size);
+        _inboundReadOffset += size;
+
+        if (!HasInbound())
+        {
+            _inbound.clear();
+            _inboundReadOffset = 0;
+        }
+    }
+
+    return _readBuffer->GetActiveSize() > 0;
+}
+void MemoryTransport::Send(std::shared_ptr<Bytebuffer> buffer)
+{
+    if (_discardOutbound || !_isConnected)
+        return;
+
+    _outbound.insert(_outbound.end(), buffer->GetDataPointer(), buffer->GetDataPointer() + buffer->writtenData);
+}
+
+void MemoryTransport::PushInbound(const u8* data, size_t size)
+{
+    _inbound.insert(_inbound.end(), data, data + size);
+}
+void MemoryTransport::TakeOutbound(std::vector<u8>& outbound)
+{
+    outbound.swap(_outbound);
+    _outbound.clear();
+}
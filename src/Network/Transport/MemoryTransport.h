@@ -0,0 +1,62 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <vector>
+#include "NetTransport.h"
+
+// Transport for simulation and replay, the peer pushes bytes in and takes the responses out on the same thread
+class MemoryTransport : public NetTransport
+{
+public:
+    static constexpr size_t READ_BUFFER_SIZE = 65536;
+
+    // If discardOutbound is set everything sent is dropped, used when nothing is listening on the other end
+    MemoryTransport(bool discardOutbound = false);
+
+    bool Read() override;
+    std::shared_ptr<Bytebuffer> GetReadBuffer() override { return _readBuffer; }
+    void Send(std::shared_ptr<Bytebuffer> buffer) override;
+
+    bool IsConnected() override { return _isConnected; }
+    void Close() override { _isConnected = false; }
+    const NetSocket::ConnectionInfo& GetConnectionInfo() override { return _connectionInfo; }
+
+    // Peer side
+    void PushInbound(const u8* data, size_t size);
+    void TakeOutbound(std::vector<u8>& outbound);
+    bool HasInbound() const { return _inboundReadOffset < _inbound.size(); }
+
+private:
+    bool _isConnected = true;
+    bool _discardOutbound = false;
+    NetSocket::ConnectionInfo _connectionInfo;
+
+    std::vector<u8> _readStorage;
+    std::shared_ptr<Bytebuffer> _readBuffer;
+
+    std::vector<u8> _inbound;
+    size_t _inboundReadOffset = 0;
+    std::vector<u8> _outbound;
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <vector>
+#include <Networking/NetSocket.h>
+#include "OutboundQueue.h"
+
+class NetClient;
+class Bytebuffer;
+
+// Moves bytes between a NetClient's packet handling and whatever is on the other end, a real socket or an in-memory peer
+class NetTransport
+{
+public:
+    NetTransport(std::shared_ptr<NetClient> netClient) : _netClient(netClient) { }
+    virtual ~NetTransport() = default;
+
+    // Pulls any pending bytes into the read buffer, returns true if the read buffer has data to frame
+    virtual bool Read() = 0;
+    virtual std::shared_ptr<Bytebuffer> GetReadBuffer() = 0;
+    // Hands a buffer to the wire, handlers go through Enqueue so the outbound queue can apply backpressure
+    virtual void Send(std::shared_ptr<Bytebuffer> buffer) = 0;
+    // Called once per tick after all packets were handled, transports that batch their sends submit them here
+    virtual void Flush() { }
+    // Bytes handed to Send which have not been written yet, transports that can't tell report 0
+    virtual size_t GetPendingSendBytes() { return 0; }
+    // Transports that keep receives posted stop them while paused, everything else simply isn't framed until resumed
+    virtual void SetReadPaused(bool paused) { }
+    // Gives up the connected socket for a hot restart along with the bytes read from it but not framed yet, the transport is left closed without closing the socket
+    // Returns -1 if the transport can't hand its socket off or still has sends in flight
+    virtual i32 Detach(std::vector<u8>& unread) { return -1; }
+    // Whether Detach can succeed once the sends in flight have been written
+    virtual bool CanDetach() { return false; }
+
+    virtual bool IsConnected() = 0;
+    virtual void Close() = 0;
+    virtual const NetSocket::ConnectionInfo& GetConnectionInfo() = 0;
+
+    // The client handlers are called with, it carries the ConnectionStatus of this transport
+    const std::shared_ptr<NetClient>& GetClient() const { return _netClient; }
+
+    OutboundQueue& GetOutboundQueue() { return _outboundQueue; }
+    bool Enqueue(std::shared_ptr<Bytebuffer> buffer) { return _outboundQueue.Push(std::move(buffer)); }
+    // Handlers run alongside the read stage, so instead of closing the transport under it they ask for FlushOutbound to close it
+    void RequestClose() { _isCloseRequested = true; }
+    bool IsCloseRequested() const { return _isCloseRequested; }
+    // Direct clients don't log in, the requester ids they send could name anyone so admission and affinity ignore them
+    void SetTrustsRequesterIds(bool trustsRequesterIds) { _trustsRequesterIds = trustsRequesterIds; }
+    bool TrustsRequesterIds() const { return _trustsRequesterIds; }
+    void FlushOutbound()
+    {
+        if (_isCloseRequested)
+        {
+            _isCloseRequested = false;
+            Close();
+            return;
+        }
+
+        _outboundQueue.MarkFlushStart();
+
+        std::shared_ptr<Bytebuffer> buffer = nullptr;
+        while (_outboundQueue.Pop(buffer))
+        {
+            Send(std::move(buffer));
+        }
+
+        Flush();
+    }
+
+protected:
+    std::shared_ptr<NetClient> _netClient;
+    OutboundQueue _outboundQueue;
+    bool _isCloseRequested = false;
+    bool _trustsRequesterIds = true;
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <deque>
+#include <memory>
+#include <Utils/ByteBuffer.h>
+
+/*
+    Bounded per-connection queue of responses waiting to be handed to the transport.
+    Depth is what we have queued plus what the transport reports as still in flight, above the high watermark reads from the connection pause until depth drops to the low watermark.
+    Transports which write synchronously (SocketTransport) never report anything in flight and leave the queue empty after every flush,
+    so the watermarks are checked against the larger of the depth after the flush and the depth the flush started with.
+    That only catches a tick which queued a lot, not a peer which reads slowly, which is why the socket backend is only the default on Windows.
+*/
+class OutboundQueue
+{
+public:
+    static constexpr size_t DEFAULT_LOW_WATERMARK = 64 * 1024;
+    static constexpr size_t DEFAULT_HIGH_WATERMARK = 256 * 1024;
+    static constexpr size_t DEFAULT_CAPACITY = 4 * 1024 * 1024;
+
+    OutboundQueue(size_t lowWatermark = DEFAULT_LOW_WATERMARK, size_t highWatermark = DEFAULT_HIGH_WATERMARK, size_t capacity = DEFAULT_CAPACITY)
+        : _lowWatermark(lowWatermark), _highWatermark(highWatermark), _capacity(capacity) { }
+
+    // Returns false if the buffer would exceed the capacity, the caller is expected to close the connection
+    bool Push(std::shared_ptr<Bytebuffer> buffer)
+    {
+        size_t size = buffer->writtenData;
+        if (GetDepth() + size > _capacity)
+            return false;
+
+        _queuedBytes += size;
+        _buffers.push_back(std::move(buffer));
+
+        _peakDepth = std::max(_peakDepth, GetDepth());
+        return true;
+    }
+    bool Pop(std::shared_ptr<Bytebuffer>& buffer)
+    {
+        if (_buffers.empty())
+            return false;
+
+        buffer = std::move(_buffers.front());
+        _buffers.pop_front();
+        _queuedBytes -= buffer->writtenData;
+        return true;
+    }
+
+    // Called by NetTransport::FlushOutbound before it hands the queue to the transport
+    void MarkFlushStart()
+    {
+        _depthAtFlush = GetDepth();
+    }
+
+    // Returns true if the read pause state changed
+    bool UpdateWatermarks(size_t transportPendingBytes)
+    {
+        _transportPendingBytes = transportPendingBytes;
+
+        size_t depth = std::max(GetDepth(), _depthAtFlush);
+        _depthAtFlush = 0;
+        _peakDepth = std::max(_peakDepth, depth);
+
+        bool wasPaused = _isReadPaused;
+        if (!_isReadPaused && depth >= _highWatermark)
+        {
+            _isReadPaused = true;
+            _numPauses++;
+        }
+        else if (_isReadPaused && depth <= _lowWatermark)
+        {
+            _isReadPaused = false;
+        }
+
+        return wasPaused != _isReadPaused;
+    }
+
+    bool IsReadPaused() const { return _isReadPaused; }
+    size_t GetDepth() const { return _queuedBytes + _transportPendingBytes; }
+    size_t GetQueuedBytes() const { return _queuedBytes; }
+    size_t GetQueuedBuffers() const { return _buffers.size(); }
+    size_t GetPeakDepth() const { return _peakDepth; }
+    u64 GetNumPauses() const { return _numPauses; }
+
+private:
+    size_t _lowWatermark;
+    size_t _highWatermark;
+    size_t _capacity;
+
+    std::deque<std::shared_ptr<Bytebuffer>> _buffers;
+    size_t _queuedBytes = 0;
+    size_t _transportPendingBytes = 0;
+    size_t _depthAtFlush = 0;
+    size_t _peakDepth = 0;
+
+    bool _isReadPaused = false;
+    u64 _numPauses = 0;
+};
\ No newline at end of file
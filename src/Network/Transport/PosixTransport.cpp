@@ -0,0 +1,191 @@
+#include "PosixTransport.h"
+#ifndef _WIN32
+#include <Utils/ByteBuffer.h>
+#include <Utils/DebugHandler.h>
+#include <Networking/NetClient.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+PosixTransport::PosixTransport(size_t readBufferSize)
+    : NetTransport(std::make_shared<NetClient>())
+{
+    // The NetClient never connects, it only carries the ConnectionStatus for the packet handlers
+    _netClient->Init(NetSocket::Mode::TCP);
+
+    ResizeReadBuffer(readBufferSize);
+}
+
+PosixTransport::~PosixTransport()
+{
+    Close();
+}
+
+bool PosixTransport::Connect(const std::string& address, u16 port)
+{
+    _socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (_socket < 0)
+        return false;
+
+    sockaddr_in socketAddress = {};
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1 ||
+        connect(_socket, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) < 0)
+    {
+        Close();
+        return false;
+    }
+
+    SetupSocket();
+    _isConnected = true;
+    return true;
+}
+
+bool PosixTransport::Adopt(i32 socket, const std::vector<u8>& unread)
+{
+    Close();
+
+    _socket = socket;
+    SetupSocket();
+
+    if (unread.size() > _readStorage.size())
+        ResizeReadBuffer(unread.size());
+
+    _readBuffer->Reset();
+    _readBuffer->PutBytes(unread.data(), unread.size());
+
+    _isConnected = true;
+    return true;
+}
+
+bool PosixTransport::Read()
+{
+    if (!_isConnected)
+        return _readBuffer->GetActiveSize() > 0;
+
+    // Framing leaves a partial packet at the front, move it down to make room
+    if (_readBuffer->GetActiveSize() == 0)
+        _readBuffer->Reset();
+    else
+        _readBuffer->Normalize();
+
+    while (size_t space = _readBuffer->GetSpace())
+    {
+        ssize_t received = recv(_socket, _readBuffer->GetWritePointer(), space, 0);
+        if (received > 0)
+        {
+            _readBuffer->writtenData += static_cast<size_t>(received);
+            continue;
+        }
+
+        // 0 means the peer closed the connection
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            _isConnected = false;
+
+        break;
+    }
+
+    return _readBuffer->GetActiveSize() > 0;
+}
+
+void PosixTransport::Send(std::shared_ptr<Bytebuffer> buffer)
+{
+    if (!_isConnected)
+        return;
+
+    _pendingSendBytes += buffer->writtenData;
+    _pendingSends.push_back({ std::move(buffer), 0 });
+
+    // Only write right away if nothing is waiting ahead of this buffer, the stream has to stay in order
+    if (_pendingSends.size() == 1)
+        Flush();
+}
+
+void PosixTransport::Flush()
+{
+    while (_isConnected && !_pendingSends.empty())
+    {
+        PendingSend& pendingSend = _pendingSends.front();
+        const u8* data = pendingSend.buffer->GetDataPointer() + pendingSend.offset;
+        size_t size = pendingSend.buffer->writtenData - pendingSend.offset;
+
+        ssize_t sent = send(_socket, data, size, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                _isConnected = false;
+
+            return;
+        }
+
+        pendingSend.offset += static_cast<size_t>(sent);
+        _pendingSendBytes -= static_cast<size_t>(sent);
+
+        // TCP took only part of the buffer, the rest goes out once the kernel has room again
+        if (pendingSend.offset < pendingSend.buffer->writtenData)
+            return;
+
+        _pendingSends.pop_front();
+    }
+}
+
+i32 PosixTransport::Detach(std::vector<u8>& unread)
+{
+    if (_socket < 0 || _pendingSendBytes > 0)
+        return -1;
+
+    unread.assign(_readBuffer->GetReadPointer(), _readBuffer->GetReadPointer() + _readBuffer->GetActiveSize());
+    _readBuffer->Reset();
+
+    i32 socket = _socket;
+    _socket = -1;
+    _isConnected = false;
+    return socket;
+}
+
+void PosixTransport::Close()
+{
+    if (_socket < 0)
+        return;
+
+    close(_socket);
+    _socket = -1;
+    _isConnected = false;
+
+    _pendingSends.clear();
+    _pendingSendBytes = 0;
+}
+
+void PosixTransport::SetupSocket()
+{
+    i32 noDelay = 1;
+    i32 bufferSize = SOCKET_BUFFER_SIZE;
+    setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    setsockopt(_socket, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+    setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) | O_NONBLOCK);
+
+    sockaddr_in peerAddress = {};
+    socklen_t peerAddressSize = sizeof(peerAddress);
+    if (getpeername(_socket, reinterpret_cast<sockaddr*>(&peerAddress), &peerAddressSize) == 0)
+    {
+        char addressString[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &peerAddress.sin_addr, addressString, sizeof(addressString));
+
+        _connectionInfo.ipAddr = peerAddress.sin_addr.s_addr;
+        _connectionInfo.ipAddrStr = addressString;
+        _connectionInfo.port = ntohs(peerAddress.sin_port);
+    }
+}
+
+void PosixTransport::ResizeReadBuffer(size_t size)
+{
+    _readStorage.resize(size);
+    _readBuffer = std::make_shared<Bytebuffer>(_readStorage.data(), _readStorage.size());
+}
+#endif // _WIN32
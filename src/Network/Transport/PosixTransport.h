@@ -0,0 +1,83 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#ifndef _WIN32
+#include <NovusTypes.h>
+#include <deque>
+#include <vector>
+#include "NetTransport.h"
+
+/*
+    Plain non-blocking socket owned by the load balancer rather than by NetClient.
+    Owning the descriptor is what lets a hot restart hand the live upstream connection to the next process, which adopts it into a transport of its own.
+*/
+class PosixTransport : public NetTransport
+{
+public:
+    static constexpr size_t READ_BUFFER_SIZE = 65536;
+    static constexpr i32 SOCKET_BUFFER_SIZE = 8192;
+
+    // Direct clients only ever send small requests and get a smaller read buffer, see ClientListenerSystem
+    PosixTransport(size_t readBufferSize = READ_BUFFER_SIZE);
+    ~PosixTransport();
+
+    bool Connect(const std::string& address, u16 port);
+    // Takes over a connected socket along with the bytes its previous owner read but never framed
+    bool Adopt(i32 socket, const std::vector<u8>& unread);
+
+    bool Read() override;
+    std::shared_ptr<Bytebuffer> GetReadBuffer() override { return _readBuffer; }
+    void Send(std::shared_ptr<Bytebuffer> buffer) override;
+    void Flush() override;
+    size_t GetPendingSendBytes() override { return _pendingSendBytes; }
+    i32 Detach(std::vector<u8>& unread) override;
+    bool CanDetach() override { return _socket >= 0; }
+
+    bool IsConnected() override { return _isConnected; }
+    void Close() override;
+    const NetSocket::ConnectionInfo& GetConnectionInfo() override { return _connectionInfo; }
+    i32 GetSocket() const { return _socket; }
+
+private:
+    struct PendingSend
+    {
+        std::shared_ptr<Bytebuffer> buffer = nullptr;
+        size_t offset = 0;
+    };
+
+    void SetupSocket();
+    void ResizeReadBuffer(size_t size);
+
+private:
+    i32 _socket = -1;
+    bool _isConnected = false;
+    NetSocket::ConnectionInfo _connectionInfo;
+
+    std::vector<u8> _readStorage;
+    std::shared_ptr<Bytebuffer> _readBuffer;
+
+    std::deque<PendingSend> _pendingSends; // Buffers the kernel did not take in full, written in order by Flush
+    size_t _pendingSendBytes = 0;
+};
+#endif // _WIN32
@@ -0,0 +1,41 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <Networking/NetClient.h>
+#include "NetTransport.h"
+
+// NetClient writes synchronously and does not tell us what it has not written, GetPendingSendBytes stays 0 and backpressure goes by OutboundQueue's depth at flush
+class SocketTransport : public NetTransport
+{
+public:
+    SocketTransport(std::shared_ptr<NetClient> netClient) : NetTransport(netClient) { }
+
+    bool Read() override { return _netClient->Read(); }
+    std::shared_ptr<Bytebuffer> GetReadBuffer() override { return _netClient->GetReadBuffer(); }
+    void Send(std::shared_ptr<Bytebuffer> buffer) override { _netClient->Send(buffer); }
+
+    bool IsConnected() override { return _netClient->IsConnected(); }
+    void Close() override { _netClient->Close(); }
+    const NetSocket::ConnectionInfo& GetConnectionInfo() override { return _netClient->GetSocket()->GetConnectionInfo(); }
+};
\ No newline at end of file
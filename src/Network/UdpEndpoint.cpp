@@ -0,0 +1,215 @@
+#include "UdpEndpoint.h"
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <utility>
+
+UdpEndpoint::~UdpEndpoint()
+{
+    Close();
+}
+
+bool UdpEndpoint::Open(const std::string& address, u16 port, size_t maxDatagramSize)
+{
+    sockaddr_in socketAddress = {};
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1)
+        return false;
+
+    _socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (_socket < 0)
+        return false;
+
+    // A hot restart binds the new process while the old one still owns the port
+    i32 reuse = 1;
+    setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#ifdef SO_REUSEPORT
+    setsockopt(_socket, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
+#endif // SO_REUSEPORT
+
+    // Bursts arrive between ticks, the kernel has to hold them until we get to them
+    i32 bufferSize = SOCKET_BUFFER_SIZE;
+    setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    setsockopt(_socket, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+
+    if (bind(_socket, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) < 0)
+    {
+        Close();
+        return false;
+    }
+
+    fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) | O_NONBLOCK);
+
+    _maxDatagramSize = maxDatagramSize;
+    Setup(_received, _receiveStorage);
+    Setup(_sends, _sendStorage);
+    _numSends = 0;
+    return true;
+}
+
+void UdpEndpoint::Close()
+{
+    if (_socket < 0)
+        return;
+
+    close(_socket);
+    _socket = -1;
+}
+
+u32 UdpEndpoint::Receive()
+{
+    if (_socket < 0)
+        return 0;
+
+    u32 numReceived = 0;
+    u32 numValid = 0;
+
+#ifdef __linux__
+    mmsghdr messages[BATCH_SIZE];
+    iovec iovs[BATCH_SIZE];
+    for (u32 i = 0; i < BATCH_SIZE; i++)
+    {
+        iovs[i] = { _received[i].data, _maxDatagramSize + 1 };
+
+        messages[i] = {};
+        messages[i].msg_hdr.msg_name = &_received[i].address;
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        messages[i].msg_hdr.msg_iov = &iovs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    i32 result = recvmmsg(_socket, messages, BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    if (result <= 0)
+        return 0;
+
+    numReceived = static_cast<u32>(result);
+    for (u32 i = 0; i < numReceived; i++)
+    {
+        if (messages[i].msg_len > _maxDatagramSize || (messages[i].msg_hdr.msg_flags & MSG_TRUNC))
+            continue;
+
+        // Keep the valid ones at the front, the address buffers move along with them
+        if (numValid != i)
+            std::swap(_received[numValid], _received[i]);
+
+        _received[numValid].size = messages[i].msg_len;
+        numValid++;
+    }
+#else
+    for (; numReceived < BATCH_SIZE; numReceived++)
+    {
+        Datagram& datagram = _received[numValid];
+        socklen_t addressSize = sizeof(datagram.address);
+
+        ssize_t result = recvfrom(_socket, datagram.data, _maxDatagramSize + 1, 0, reinterpret_cast<sockaddr*>(&datagram.address), &addressSize);
+        if (result < 0)
+            break;
+
+        if (static_cast<size_t>(result) > _maxDatagramSize)
+            continue;
+
+        datagram.size = static_cast<size_t>(result);
+        numValid++;
+    }
+#endif // __linux__
+
+    _numReceived += numValid;
+    _numDropped += numReceived - numValid;
+    return numValid;
+}
+
+u8* UdpEndpoint::Prepare()
+{
+    if (_numSends == BATCH_SIZE)
+        Flush();
+
+    return _sends[_numSends].data;
+}
+
+void UdpEndpoint::Commit(const sockaddr_in& address, size_t size)
+{
+    Datagram& datagram = _sends[_numSends];
+    datagram.address = address;
+    datagram.size = size;
+    _numSends++;
+}
+
+void UdpEndpoint::Flush()
+{
+    if (_socket < 0 || _numSends == 0)
+        return;
+
+    u32 numSent = 0;
+
+#ifdef __linux__
+    mmsghdr messages[BATCH_SIZE];
+    iovec iovs[BATCH_SIZE];
+    for (u32 i = 0; i < _numSends; i++)
+    {
+        iovs[i] = { _sends[i].data, _sends[i].size };
+
+        messages[i] = {};
+        messages[i].msg_hdr.msg_name = &_sends[i].address;
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        messages[i].msg_hdr.msg_iov = &iovs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // sendmmsg stops at the first datagram it can't send, skip that one and hand it the rest
+    u32 index = 0;
+    while (index < _numSends)
+    {
+        i32 result = sendmmsg(_socket, messages + index, _numSends - index, MSG_DONTWAIT);
+        if (result > 0)
+        {
+            index += static_cast<u32>(result);
+            numSent += static_cast<u32>(result);
+            continue;
+        }
+
+        if (errno == EINTR)
+            continue;
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+
+        index++;
+    }
+
+    _numDropped += _numSends - numSent;
+#else
+    for (u32 i = 0; i < _numSends; i++)
+    {
+        const Datagram& datagram = _sends[i];
+        if (sendto(_socket, datagram.data, datagram.size, 0, reinterpret_cast<const sockaddr*>(&datagram.address), sizeof(datagram.address)) < 0)
+        {
+            _numDropped++;
+            continue;
+        }
+
+        numSent++;
+    }
+#endif // __linux__
+
+    _numSent += numSent;
+    _numSends = 0;
+}
+
+void UdpEndpoint::Setup(std::vector<Datagram>& datagrams, std::vector<u8>& storage)
+{
+    // One extra byte tells a datagram which was too large apart from one which just fits
+    size_t stride = _maxDatagramSize + 1;
+    storage.resize(stride * BATCH_SIZE);
+    datagrams.resize(BATCH_SIZE);
+
+    for (u32 i = 0; i < BATCH_SIZE; i++)
+    {
+        datagrams[i].address = {};
+        datagrams[i].data = storage.data() + stride * i;
+        datagrams[i].size = 0;
+    }
+}
+#endif // _WIN32
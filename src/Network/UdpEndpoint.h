@@ -0,0 +1,87 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#ifndef _WIN32
+#include <NovusTypes.h>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/*
+    Non-blocking UDP socket which receives and sends in batches, one recvmmsg and one sendmmsg move up to BATCH_SIZE datagrams.
+    Other platforms fall back to a recvfrom and sendto per datagram.
+*/
+class UdpEndpoint
+{
+public:
+    static constexpr u32 BATCH_SIZE = 64;
+    static constexpr i32 SOCKET_BUFFER_SIZE = 1 << 20;
+
+    struct Datagram
+    {
+        sockaddr_in address;
+        u8* data = nullptr; // Points into the endpoint's storage, maxDatagramSize bytes
+        size_t size = 0;
+    };
+
+    ~UdpEndpoint();
+
+    // Datagrams larger than maxDatagramSize are truncated by the kernel and dropped by Receive
+    bool Open(const std::string& address, u16 port, size_t maxDatagramSize);
+    bool IsOpen() const { return _socket >= 0; }
+    void Close();
+
+    // Returns how many datagrams were received, valid until the next call
+    u32 Receive();
+    const Datagram& GetReceived(u32 index) const { return _received[index]; }
+
+    // Returns a buffer of maxDatagramSize bytes to write the datagram to, Commit queues it. Sends once a batch is full
+    u8* Prepare();
+    void Commit(const sockaddr_in& address, size_t size);
+    // Sends whatever is queued, datagrams the kernel had no room for are dropped like any other lost datagram
+    void Flush();
+
+    u64 GetNumReceived() const { return _numReceived; }
+    u64 GetNumSent() const { return _numSent; }
+    u64 GetNumDropped() const { return _numDropped; }
+
+private:
+    void Setup(std::vector<Datagram>& datagrams, std::vector<u8>& storage);
+
+private:
+    i32 _socket = -1;
+    size_t _maxDatagramSize = 0;
+
+    std::vector<Datagram> _received;
+    std::vector<u8> _receiveStorage;
+    std::vector<Datagram> _sends;
+    std::vector<u8> _sendStorage;
+    u32 _numSends = 0;
+
+    u64 _numReceived = 0;
+    u64 _numSent = 0;
+    u64 _numDropped = 0; // Truncated on receive or refused by the kernel on send
+};
+#endif // _WIN32
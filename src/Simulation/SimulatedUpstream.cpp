@@ -0,0 +1,211 @@
+#include "SimulatedUpstream.h"
+#include <Utils/DebugHandler.h>
+#include <Networking/NetClient.h>
+#include <cmath>
+#include <limits>
+#include "../Network/Transport/MemoryTransport.h"
+#include "../ECS/Components/Network/AdmissionSingleton.h"
+
+SimulatedUpstream::SimulatedUpstream(const SimulationSettings& settings, std::shared_ptr<MemoryTransport> transport)
+    : _settings(settings), _transport(transport), _start(std::chrono::steady_clock::now()), _randomState(settings.seed)
+{
+    _outbound.reserve(65536);
+}
+
+void SimulatedUpstream::Connect()
+{
+    // The simulated upstream trusts us, skip the SRP handshake
+    _transport->GetClient()->SetConnectionStatus(ConnectionStatus::CONNECTED);
+
+    std::vector<ServerInformation> servers;
+    servers.push_back(CreateServer(AddressType::AUTH));
+    servers.push_back(CreateServer(AddressType::AUTH));
+    servers.push_back(CreateServer(AddressType::REALM));
+
+    for (u32 i = 0; i < _settings.initialWorldServers; i++)
+    {
+        ServerInformation server = CreateServer(AddressType::WORLD);
+        servers.push_back(server);
+        _worldServers.push_back(server);
+    }
+
+    PushPacket(Opcode::SMSG_SEND_FULL_INTERNAL_SERVER_INFO, reinterpret_cast<const u8*>(servers.data()), static_cast<u16>(servers.size() * sizeof(ServerInformation)));
+}
+
+void SimulatedUpstream::Update()
+{
+    if (NextUnit() < _settings.churnChancePerTick)
+    {
+        bool shouldAdd = _worldServers.size() < _settings.maxWorldServers && (_worldServers.size() <= 1 || NextUnit() < 0.5);
+        if (shouldAdd)
+            AddWorldServer();
+        else
+            RemoveWorldServer();
+    }
+
+    static constexpr AddressType requestTypes[] = { AddressType::AUTH, AddressType::REALM, AddressType::WORLD, AddressType::WORLD };
+
+    u8 payload[sizeof(AddressType) + sizeof(u64) + sizeof(u64)];
+    for (u32 i = 0; i < _settings.requestsPerTick; i++)
+    {
+        // The cookie carries the request id and the wall time it was sent, the response echoes it back
+        u64 sentAt = GetElapsedNs();
+        payload[0] = static_cast<u8>(requestTypes[NextRandom() % 4]);
+        std::memcpy(&payload[1], &_requestsSent, sizeof(u64));
+        std::memcpy(&payload[1 + sizeof(u64)], &sentAt, sizeof(u64));
+
+        PushPacket(Opcode::MSG_REQUEST_ADDRESS, payload, sizeof(payload));
+        _requestsSent++;
+    }
+}
+
+void SimulatedUpstream::Collect()
+{
+    _transport->TakeOutbound(_outbound);
+    u64 receivedAt = GetElapsedNs();
+
+    size_t offset = 0;
+    while (offset + sizeof(PacketHeader) <= _outbound.size())
+    {
+        PacketHeader header;
+        std::memcpy(&header, &_outbound[offset], sizeof(PacketHeader));
+        offset += sizeof(PacketHeader);
+
+        if (offset + header.size > _outbound.size())
+            break;
+
+        const u8* payload = &_outbound[offset];
+        offset += header.size;
+
+        if (header.opcode != Opcode::SMSG_SEND_ADDRESS || header.size == 0)
+            continue;
+
+        _responses++;
+
+        if (payload[0] == static_cast<u8>(AddressStatus::BUSY))
+        {
+            _busy++;
+            continue;
+        }
+
+        constexpr size_t addressSize = sizeof(u8) + sizeof(u32) + sizeof(u16);
+        if (payload[0] == static_cast<u8>(AddressStatus::NOT_FOUND) || header.size < addressSize + sizeof(u64) + sizeof(u64))
+        {
+            _failures++;
+            continue;
+        }
+
+        u32 address = 0;
+        u16 port = 0;
+        u64 sentAt = 0;
+        std::memcpy(&address, &payload[1], sizeof(u32));
+        std::memcpy(&port, &payload[5], sizeof(u16));
+        std::memcpy(&sentAt, &payload[addressSize + sizeof(u64)], sizeof(u64));
+
+        _assignments[(static_cast<u64>(address) << 16) | port]++;
+
+        u64 latency = receivedAt - sentAt;
+        _totalLatencyNs += latency;
+        _maxLatencyNs = std::max(_maxLatencyNs, latency);
+    }
+
+    _outbound.clear();
+}
+
+void SimulatedUpstream::PrintReport(f64 wallTime) const
+{
+    u64 minAssignments = std::numeric_limits<u64>::max();
+    u64 maxAssignments = 0;
+    f64 mean = 0.0;
+    f64 variance = 0.0;
+
+    for (auto& assignment : _assignments)
+    {
+        minAssignments = std::min(minAssignments, assignment.second);
+        maxAssignments = std::max(maxAssignments, assignment.second);
+        mean += static_cast<f64>(assignment.second);
+    }
+
+    size_t numBackends = _assignments.size();
+    if (numBackends)
+    {
+        mean /= numBackends;
+        for (auto& assignment : _assignments)
+        {
+            f64 difference = static_cast<f64>(assignment.second) - mean;
+            variance += difference * difference;
+        }
+        variance /= numBackends;
+    }
+    else
+    {
+        minAssignments = 0;
+    }
+
+    u64 numAnswered = _failures + _busy;
+    f64 averageLatencyNs = _responses > numAnswered ? static_cast<f64>(_totalLatencyNs) / (_responses - numAnswered) : 0.0;
+
+    DebugHandler::PrintSuccess("[Simulation]: Simulated %.0fs in %.3fs (seed %llu)", _settings.duration, wallTime, static_cast<unsigned long long>(_settings.seed));
+    DebugHandler::PrintSuccess("[Simulation]: Requests: %llu, Responses: %llu, Failures: %llu, Busy: %llu, Topology changes: %llu", static_cast<unsigned long long>(_requestsSent), static_cast<unsigned long long>(_responses), static_cast<unsigned long long>(_failures), static_cast<unsigned long long>(_busy), static_cast<unsigned long long>(_topologyChanges));
+    DebugHandler::PrintSuccess("[Simulation]: Backends: %llu, Assignments min/mean/max: %llu/%.1f/%llu, Coefficient of variation: %.4f", static_cast<unsigned long long>(numBackends), static_cast<unsigned long long>(minAssignments), mean, static_cast<unsigned long long>(maxAssignments), mean > 0.0 ? std::sqrt(variance) / mean : 0.0);
+    DebugHandler::PrintSuccess("[Simulation]: Wall latency avg/max: %.3fms/%.3fms", averageLatencyNs / 1000000.0, static_cast<f64>(_maxLatencyNs) / 1000000.0);
+}
+
+void SimulatedUpstream::PushPacket(Opcode opcode, const u8* payload, u16 size)
+{
+    PacketHeader header;
+    header.opcode = opcode;
+    header.size = size;
+
+    _transport->PushInbound(reinterpret_cast<const u8*>(&header), sizeof(PacketHeader));
+    _transport->PushInbound(payload, size);
+}
+
+ServerInformation SimulatedUpstream::CreateServer(AddressType type)
+{
+    ServerInformation server;
+    server.entity = static_cast<entt::entity>(_nextEntity++);
+    server.type = type;
+    server.realmId = 0;
+    server.address = _nextAddress++;
+    server.port = 8000;
+
+    return server;
+}
+
+void SimulatedUpstream::AddWorldServer()
+{
+    ServerInformation server = CreateServer(AddressType::WORLD);
+    _worldServers.push_back(server);
+
+    PushPacket(Opcode::SMSG_SEND_ADD_INTERNAL_SERVER_INFO, reinterpret_cast<const u8*>(&server), sizeof(ServerInformation));
+    _topologyChanges++;
+}
+
+void SimulatedUpstream::RemoveWorldServer()
+{
+    if (_worldServers.empty())
+        return;
+
+    size_t index = NextRandom() % _worldServers.size();
+    ServerInformation server = _worldServers[index];
+    _worldServers[index] = _worldServers.back();
+    _worldServers.pop_back();
+
+    u8 payload[sizeof(entt::entity) + sizeof(AddressType) + sizeof(u8)];
+    std::memcpy(&payload[0], &server.entity, sizeof(entt::entity));
+    payload[sizeof(entt::entity)] = static_cast<u8>(server.type);
+    payload[sizeof(entt::entity) + sizeof(AddressType)] = server.realmId;
+
+    PushPacket(Opcode::SMSG_SEND_REMOVE_INTERNAL_SERVER_INFO, payload, sizeof(payload));
+    _topologyChanges++;
+}
+
+u64 SimulatedUpstream::NextRandom()
+{
+    // SplitMix64, the same seed gives the same run on every platform
+    u64 z = (_randomState += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,90 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <Networking/NetStructures.h>
+#include <chrono>
+#include <vector>
+#include "../ECS/Components/Network/LoadBalanceSingleton.h"
+
+class MemoryTransport;
+
+struct SimulationSettings
+{
+    bool enabled = false;
+    f64 duration = 3600.0; // Simulated seconds
+    u64 seed = 1;
+
+    u32 requestsPerTick = 256;
+    u32 initialWorldServers = 16;
+    u32 maxWorldServers = 64;
+    f32 churnChancePerTick = 0.05f; // Chance that a world server is added or removed each tick
+};
+
+// Plays the upstream server against a MemoryTransport, feeding topology churn and address requests and measuring the responses
+class SimulatedUpstream
+{
+public:
+    SimulatedUpstream(const SimulationSettings& settings, std::shared_ptr<MemoryTransport> transport);
+
+    void Connect();
+    void Update();
+    void Collect();
+    bool IsDone(f64 lifeTime) const { return lifeTime >= _settings.duration; }
+
+    void PrintReport(f64 wallTime) const;
+
+private:
+    void PushPacket(Opcode opcode, const u8* payload, u16 size);
+    ServerInformation CreateServer(AddressType type);
+    void AddWorldServer();
+    void RemoveWorldServer();
+
+    u64 GetElapsedNs() const { return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count()); }
+
+    u64 NextRandom();
+    f64 NextUnit() { return static_cast<f64>(NextRandom() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    SimulationSettings _settings;
+    std::shared_ptr<MemoryTransport> _transport;
+    std::chrono::steady_clock::time_point _start;
+
+    u64 _randomState = 0;
+    u32 _nextEntity = 0;
+    u32 _nextAddress = 0x0A000001; // 10.0.0.1
+    std::vector<ServerInformation> _worldServers;
+    std::vector<u8> _outbound;
+
+    u64 _requestsSent = 0;
+    u64 _responses = 0;
+    u64 _failures = 0;
+    u64 _busy = 0;
+    u64 _topologyChanges = 0;
+    u64 _totalLatencyNs = 0; // Wall time from pushing a request to collecting its response, simulated time doesn't move within a tick
+    u64 _maxLatencyNs = 0;
+
+    // Assignments per (address << 16 | port)
+    robin_hood::unordered_map<u64, u64> _assignments;
+};
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include "AffinityTable.h"
+#include <entity/entity.hpp>
+
+void AffinityTable::Init(u32 maxEntries, f32 ttl)
+{
+    // Keeping the load factor at or below one half keeps probe chains short
+    u32 capacity = 16;
+    while (capacity < maxEntries * 2)
+        capacity <<= 1;
+
+    _slots.assign(capacity, Slot());
+    _mask = capacity - 1;
+    _maxEntries = maxEntries;
+    _ttl = ttl;
+
+    _size = 0;
+    _head = INVALID_SLOT;
+    _tail = INVALID_SLOT;
+}
+
+void AffinityTable::Clear()
+{
+    for (Slot& slot : _slots)
+        slot = Slot();
+
+    _size = 0;
+    _head = INVALID_SLOT;
+    _tail = INVALID_SLOT;
+}
+
+entt::entity AffinityTable::Lookup(u64 identity, u16 scope, f32 now)
+{
+    u32 index = FindSlot(identity, scope);
+    if (index == INVALID_SLOT)
+        return entt::null;
+
+    Slot& slot = _slots[index];
+    if (now >= slot.expiresAt)
+    {
+        _numExpired++;
+        EraseSlot(index);
+        return entt::null;
+    }
+
+    slot.expiresAt = now + _ttl;
+    if (index != _head)
+    {
+        Unlink(index);
+        LinkFront(index);
+    }
+
+    return slot.backend;
+}
+
+void AffinityTable::Insert(u64 identity, u16 scope, entt::entity backend, f32 now)
+{
+    if (_maxEntries == 0)
+        return;
+
+    u32 index = FindSlot(identity, scope);
+    if (index != INVALID_SLOT)
+    {
+        Slot& slot = _slots[index];
+        slot.backend = backend;
+        slot.expiresAt = now + _ttl;
+        if (index != _head)
+        {
+            Unlink(index);
+            LinkFront(index);
+        }
+        return;
+    }
+
+    if (_size >= _maxEntries)
+    {
+        // Expired entries are only dropped when looked up, the tail is the least recently used whether it expired or not
+        if (_slots[_tail].expiresAt <= now)
+            _numExpired++;
+        else
+            _numEvicted++;
+
+        EraseSlot(_tail);
+    }
+
+    index = static_cast<u32>(Hash(identity, scope)) & _mask;
+    while (_slots[index].isUsed)
+        index = (index + 1) & _mask;
+
+    Slot& slot = _slots[index];
+    slot.identity = identity;
+    slot.scope = scope;
+    slot.backend = backend;
+    slot.expiresAt = now + _ttl;
+    slot.isUsed = true;
+    LinkFront(index);
+    _size++;
+}
+
+bool AffinityTable::Erase(u64 identity, u16 scope)
+{
+    u32 index = FindSlot(identity, scope);
+    if (index == INVALID_SLOT)
+        return false;
+
+    EraseSlot(index);
+    return true;
+}
+
+u64 AffinityTable::Hash(u64 identity, u16 scope)
+{
+    // splitmix64 finalizer, requester ids are often sequential and would otherwise fill neighbouring slots
+    u64 hash = identity ^ (static_cast<u64>(scope) << 48);
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+u32 AffinityTable::FindSlot(u64 identity, u16 scope) const
+{
+    if (_size == 0)
+        return INVALID_SLOT;
+
+    u32 index = static_cast<u32>(Hash(identity, scope)) & _mask;
+    while (_slots[index].isUsed)
+    {
+        const Slot& slot = _slots[index];
+        if (slot.identity == identity && slot.scope == scope)
+            return index;
+
+        index = (index + 1) & _mask;
+    }
+
+    return INVALID_SLOT;
+}
+
+void AffinityTable::EraseSlot(u32 index)
+{
+    Unlink(index);
+    _slots[index] = Slot();
+    _size--;
+
+    // Shift the rest of the probe chain back into the hole, an entry may only move if the hole lies between its home slot and where it sits now
+    u32 hole = index;
+    u32 next = (hole + 1) & _mask;
+    while (_slots[next].isUsed)
+    {
+        u32 home = GetHome(_slots[next]);
+        bool canMove = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (canMove)
+        {
+            MoveSlot(next, hole);
+            hole = next;
+        }
+
+        next = (next + 1) & _mask;
+    }
+}
+
+void AffinityTable::MoveSlot(u32 from, u32 to)
+{
+    Slot& slot = _slots[to];
+    slot = _slots[from];
+    _slots[from] = Slot();
+
+    // The LRU neighbours still point at the old index
+    if (slot.prev != INVALID_SLOT)
+        _slots[slot.prev].next = to;
+    else
+        _head = to;
+
+    if (slot.next != INVALID_SLOT)
+        _slots[slot.next].prev = to;
+    else
+        _tail = to;
+}
+
+void AffinityTable::Unlink(u32 index)
+{
+    Slot& slot = _slots[index];
+    if (slot.prev != INVALID_SLOT)
+        _slots[slot.prev].next = slot.next;
+    else
+        _head = slot.next;
+
+    if (slot.next != INVALID_SLOT)
+        _slots[slot.next].prev = slot.prev;
+    else
+        _tail = slot.prev;
+
+    slot.prev = INVALID_SLOT;
+    slot.next = INVALID_SLOT;
+}
+
+void AffinityTable::LinkFront(u32 index)
+{
+    Slot& slot = _slots[index];
+    slot.prev = INVALID_SLOT;
+    slot.next = _head;
+
+    if (_head != INVALID_SLOT)
+        _slots[_head].prev = index;
+    else
+        _tail = index;
+
+    _head = index;
+}
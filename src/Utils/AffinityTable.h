@@ -0,0 +1,89 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <vector>
+
+/*
+    Bounded map from a requester identity (and the scope it asked in) to the backend it was last given.
+    Open addressing with linear probing over a power of two slot array sized at twice the entry limit, removals shift the probe chain back so there are no tombstones.
+    Entries are kept in LRU order through slot indices, the least recently used one is evicted when the table is full. An entry expires ttl seconds after it was last used.
+*/
+class AffinityTable
+{
+public:
+    static constexpr u32 INVALID_SLOT = ~0u;
+
+    // Allocates every slot up front, the table never grows past maxEntries
+    void Init(u32 maxEntries, f32 ttl);
+    void Clear();
+
+    // Returns entt::null if the identity has no backend or its entry expired, a hit moves the entry to the front and restarts its ttl
+    entt::entity Lookup(u64 identity, u16 scope, f32 now);
+    void Insert(u64 identity, u16 scope, entt::entity backend, f32 now);
+    bool Erase(u64 identity, u16 scope);
+
+    u32 GetSize() const { return _size; }
+    u32 GetMaxEntries() const { return _maxEntries; }
+    f32 GetTTL() const { return _ttl; }
+
+    u64 GetNumEvicted() const { return _numEvicted; }
+    u64 GetNumExpired() const { return _numExpired; }
+
+private:
+    struct Slot
+    {
+        u64 identity = 0;
+        entt::entity backend;
+        f32 expiresAt = 0.0f;
+        u32 prev = INVALID_SLOT; // Towards the most recently used entry
+        u32 next = INVALID_SLOT; // Towards the least recently used entry
+        u16 scope = 0;
+        bool isUsed = false;
+    };
+
+    static u64 Hash(u64 identity, u16 scope);
+    u32 GetHome(const Slot& slot) const { return static_cast<u32>(Hash(slot.identity, slot.scope)) & _mask; }
+
+    u32 FindSlot(u64 identity, u16 scope) const;
+    void EraseSlot(u32 index);
+    void MoveSlot(u32 from, u32 to);
+
+    void Unlink(u32 index);
+    void LinkFront(u32 index);
+
+private:
+    std::vector<Slot> _slots;
+    u32 _mask = 0;
+    u32 _size = 0;
+    u32 _maxEntries = 0;
+    f32 _ttl = 0.0f;
+
+    u32 _head = INVALID_SLOT; // Most recently used
+    u32 _tail = INVALID_SLOT; // Least recently used
+
+    u64 _numEvicted = 0;
+    u64 _numExpired = 0;
+};
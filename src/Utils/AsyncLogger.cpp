@@ -0,0 +1,272 @@
+#include "AsyncLogger.h"
+#include <Utils/DebugHandler.h>
+#include <chrono>
+#include <cstdio>
+
+AsyncLogger::Cell AsyncLogger::_cells[AsyncLogger::RING_SIZE];
+std::atomic<size_t> AsyncLogger::_enqueuePosition { 0 };
+size_t AsyncLogger::_dequeuePosition = 0;
+
+std::atomic<u64> AsyncLogger::_droppedRecords { 0 };
+std::atomic<bool> AsyncLogger::_isRunning { false };
+std::thread AsyncLogger::_thread;
+
+static_assert((AsyncLogger::RING_SIZE & (AsyncLogger::RING_SIZE - 1)) == 0, "AsyncLogger::RING_SIZE must be a power of two");
+
+void AsyncLogger::Start()
+{
+    if (_isRunning.exchange(true))
+        return;
+
+    for (size_t i = 0; i < RING_SIZE; i++)
+    {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    _enqueuePosition.store(0, std::memory_order_relaxed);
+    _dequeuePosition = 0;
+
+    _thread = std::thread(&AsyncLogger::Run);
+}
+void AsyncLogger::Stop()
+{
+    if (!_isRunning.exchange(false))
+        return;
+
+    _thread.join();
+}
+
+u16 AsyncLogger::PackString(Record& record, const char* string)
+{
+    u16 offset = record.stringDataSize;
+    if (offset >= MAX_STRING_DATA)
+        return static_cast<u16>(MAX_STRING_DATA - 1);
+
+    // Copy as much as fits, the string is always null terminated
+    size_t length = string ? strnlen(string, MAX_STRING_DATA - offset - 1) : 0;
+    std::memcpy(&record.stringData[offset], string, length);
+    record.stringData[offset + length] = '\0';
+
+    record.stringDataSize = static_cast<u16>(offset + length + 1);
+    return offset;
+}
+
+// Bounded MPSC ring (Dmitry Vyukov's bounded queue), each cell's sequence tells producers and the consumer who owns it
+AsyncLogger::Cell* AsyncLogger::AcquireCell()
+{
+    size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Cell* cell = &_cells[position & (RING_SIZE - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+        if (difference == 0)
+        {
+            if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                return cell;
+        }
+        else if (difference < 0)
+        {
+            // The ring is full
+            return nullptr;
+        }
+        else
+        {
+            position = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+void AsyncLogger::PublishCell(Cell* cell)
+{
+    size_t position = cell->sequence.load(std::memory_order_relaxed);
+    cell->sequence.store(position + 1, std::memory_order_release);
+}
+
+void AsyncLogger::Run()
+{
+    while (_isRunning.load(std::memory_order_relaxed))
+    {
+        if (!Flush())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Make sure we print everything that was logged before Stop was called
+    while (Flush());
+}
+bool AsyncLogger::Flush()
+{
+    bool didFlush = false;
+    char buffer[512];
+
+    while (true)
+    {
+        Cell* cell = &_cells[_dequeuePosition & (RING_SIZE - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if (sequence != _dequeuePosition + 1)
+            break;
+
+        const Record& record = cell->record;
+        Format(record, buffer, sizeof(buffer));
+
+        switch (record.level)
+        {
+            case Level::PRINT:
+                DebugHandler::Print("%s", buffer);
+                break;
+            case Level::SUCCESS:
+                DebugHandler::PrintSuccess("%s", buffer);
+                break;
+            case Level::WARNING:
+                DebugHandler::PrintWarning("%s", buffer);
+                break;
+            case Level::ERR:
+                DebugHandler::PrintError("%s", buffer);
+                break;
+        }
+
+        cell->sequence.store(_dequeuePosition + RING_SIZE, std::memory_order_release);
+        _dequeuePosition++;
+        didFlush = true;
+    }
+
+    u64 droppedRecords = _droppedRecords.exchange(0, std::memory_order_relaxed);
+    if (droppedRecords)
+    {
+        DebugHandler::PrintWarning("[AsyncLogger]: Dropped %llu records, the log ring was full", static_cast<unsigned long long>(droppedRecords));
+    }
+
+    return didFlush;
+}
+void AsyncLogger::Format(const Record& record, char* buffer, size_t size)
+{
+    const char* format = record.format;
+    size_t written = 0;
+    u8 argumentIndex = 0;
+
+    auto append = [&](i32 result)
+    {
+        if (result > 0)
+            written = std::min(written + static_cast<size_t>(result), size - 1);
+    };
+
+    while (*format && written < size - 1)
+    {
+        if (*format != '%')
+        {
+            buffer[written++] = *format++;
+            continue;
+        }
+
+        if (format[1] == '%')
+        {
+            buffer[written++] = '%';
+            format += 2;
+            continue;
+        }
+
+        // Extract a single conversion specification (flags, width, precision, length and conversion) and let snprintf handle it
+        const char* specStart = format++;
+        while (*format && !std::strchr("diouxXeEfFgGaAcspn", *format))
+            format++;
+
+        if (!*format)
+            break;
+
+        char conversion = *format++;
+        char spec[32];
+        size_t specLength = std::min(static_cast<size_t>(format - specStart), sizeof(spec) - 1);
+        std::memcpy(spec, specStart, specLength);
+        spec[specLength] = '\0';
+
+        if (argumentIndex >= record.numArguments)
+        {
+            append(snprintf(&buffer[written], size - written, "<missing>"));
+            continue;
+        }
+
+        const Argument& argument = record.arguments[argumentIndex++];
+        char* output = &buffer[written];
+        size_t space = size - written;
+
+        // Length modifiers in the spec are replaced by the widest type so the stored 64 bit value is passed correctly
+        char normalizedSpec[40];
+        size_t normalizedLength = 0;
+        for (size_t i = 0; i < specLength - 1; i++)
+        {
+            if (!std::strchr("hljztL", spec[i]))
+                normalizedSpec[normalizedLength++] = spec[i];
+        }
+
+        switch (conversion)
+        {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'c':
+            {
+                if (conversion != 'c')
+                {
+                    normalizedSpec[normalizedLength++] = 'l';
+                    normalizedSpec[normalizedLength++] = 'l';
+                }
+                normalizedSpec[normalizedLength++] = conversion;
+                normalizedSpec[normalizedLength] = '\0';
+
+                long long value = argument.type == Argument::Type::FLOAT ? static_cast<long long>(argument.f) : static_cast<long long>(argument.i);
+
+                // %c takes an int, everything else was widened to long long above
+                if (conversion == 'c')
+                    append(snprintf(output, space, normalizedSpec, static_cast<int>(value)));
+                else
+                    append(snprintf(output, space, normalizedSpec, value));
+                break;
+            }
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+            {
+                normalizedSpec[normalizedLength++] = conversion;
+                normalizedSpec[normalizedLength] = '\0';
+
+                f64 value = argument.f;
+                if (argument.type == Argument::Type::SIGNED)
+                    value = static_cast<f64>(argument.i);
+                else if (argument.type == Argument::Type::UNSIGNED)
+                    value = static_cast<f64>(argument.u);
+
+                append(snprintf(output, space, normalizedSpec, value));
+                break;
+            }
+            case 's':
+            {
+                normalizedSpec[normalizedLength++] = conversion;
+                normalizedSpec[normalizedLength] = '\0';
+
+                const char* string = argument.type == Argument::Type::STRING ? &record.stringData[argument.stringOffset] : "<invalid>";
+                append(snprintf(output, space, normalizedSpec, string));
+                break;
+            }
+            case 'p':
+            {
+                append(snprintf(output, space, "%p", argument.p));
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    buffer[written] = '\0';
+}
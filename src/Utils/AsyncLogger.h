@@ -0,0 +1,183 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+/*
+    Hot path logger, producers only copy the format pointer and the raw arguments into a preallocated ring.
+    Records are formatted and printed through DebugHandler on a background thread.
+    The format string must outlive the record (string literals), string arguments are copied into the record.
+*/
+class AsyncLogger
+{
+public:
+    enum class Level : u8
+    {
+        PRINT,
+        SUCCESS,
+        WARNING,
+        ERR
+    };
+
+    static constexpr size_t MAX_ARGUMENTS = 8;
+    static constexpr size_t MAX_STRING_DATA = 64;
+    static constexpr size_t RING_SIZE = 2048;
+
+    struct Argument
+    {
+        enum class Type : u8
+        {
+            SIGNED,
+            UNSIGNED,
+            FLOAT,
+            POINTER,
+            STRING
+        };
+
+        Type type;
+        union
+        {
+            i64 i;
+            u64 u;
+            f64 f;
+            const void* p;
+            u16 stringOffset;
+        };
+    };
+
+    struct Record
+    {
+        const char* format = nullptr;
+        Level level = Level::PRINT;
+        u8 numArguments = 0;
+        u16 stringDataSize = 0;
+        Argument arguments[MAX_ARGUMENTS];
+        char stringData[MAX_STRING_DATA];
+    };
+
+    static void Start();
+    static void Stop();
+
+    template <typename... Args>
+    static void Print(const char* format, Args... args) { Log(Level::PRINT, format, args...); }
+    template <typename... Args>
+    static void PrintSuccess(const char* format, Args... args) { Log(Level::SUCCESS, format, args...); }
+    template <typename... Args>
+    static void PrintWarning(const char* format, Args... args) { Log(Level::WARNING, format, args...); }
+    template <typename... Args>
+    static void PrintError(const char* format, Args... args) { Log(Level::ERR, format, args...); }
+
+    template <typename... Args>
+    static void Log(Level level, const char* format, Args... args)
+    {
+        static_assert(sizeof...(Args) <= MAX_ARGUMENTS, "AsyncLogger supports at most MAX_ARGUMENTS arguments");
+
+        Cell* cell = AcquireCell();
+        if (!cell)
+        {
+            _droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Record& record = cell->record;
+        record.format = format;
+        record.level = level;
+        record.numArguments = 0;
+        record.stringDataSize = 0;
+        (PackArgument(record, args), ...);
+
+        PublishCell(cell);
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    template <typename T>
+    static void PackArgument(Record& record, T value)
+    {
+        Argument& argument = record.arguments[record.numArguments++];
+
+        if constexpr (std::is_enum_v<T>)
+        {
+            argument.type = Argument::Type::UNSIGNED;
+            argument.u = static_cast<u64>(static_cast<std::underlying_type_t<T>>(value));
+        }
+        else if constexpr (std::is_same_v<T, bool>)
+        {
+            argument.type = Argument::Type::UNSIGNED;
+            argument.u = value ? 1 : 0;
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            argument.type = Argument::Type::SIGNED;
+            argument.i = static_cast<i64>(value);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            argument.type = Argument::Type::UNSIGNED;
+            argument.u = static_cast<u64>(value);
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            argument.type = Argument::Type::FLOAT;
+            argument.f = static_cast<f64>(value);
+        }
+        else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>)
+        {
+            argument.type = Argument::Type::STRING;
+            argument.stringOffset = PackString(record, value);
+        }
+        else
+        {
+            static_assert(std::is_pointer_v<T>, "AsyncLogger arguments must be arithmetic, enums, pointers or C strings");
+
+            argument.type = Argument::Type::POINTER;
+            argument.p = static_cast<const void*>(value);
+        }
+    }
+
+    static u16 PackString(Record& record, const char* string);
+    static Cell* AcquireCell();
+    static void PublishCell(Cell* cell);
+
+    static void Run();
+    static bool Flush();
+    static void Format(const Record& record, char* buffer, size_t size);
+
+private:
+    static Cell _cells[RING_SIZE];
+    static std::atomic<size_t> _enqueuePosition;
+    static size_t _dequeuePosition;
+
+    static std::atomic<u64> _droppedRecords;
+    static std::atomic<bool> _isRunning;
+    static std::thread _thread;
+};
\ No newline at end of file
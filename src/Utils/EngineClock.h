@@ -0,0 +1,91 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <thread>
+#include <Utils/Timer.h>
+#include <tracy/Tracy.hpp>
+
+// Drives TimeSingleton, the engine loop only talks to this so time can be simulated
+class EngineClock
+{
+public:
+    virtual ~EngineClock() = default;
+
+    virtual void Tick() = 0;
+    virtual f32 GetDeltaTime() = 0;
+    virtual f64 GetLifeTime() = 0;
+    virtual void WaitForTickRate(f32 targetDelta) = 0;
+};
+
+class WallClock : public EngineClock
+{
+public:
+    void Tick() override { _timer.Tick(); }
+    f32 GetDeltaTime() override { return _timer.GetDeltaTime(); }
+    f64 GetLifeTime() override { return _timer.GetLifeTime(); }
+
+    void WaitForTickRate(f32 targetDelta) override
+    {
+        ZoneScopedNC("WaitForTickRate", tracy::Color::AntiqueWhite1)
+
+        // Wait for tick rate, this might be an overkill implementation but it has the even tickrate I've seen - MPursche
+        {
+            ZoneScopedNC("Sleep", tracy::Color::AntiqueWhite1)
+            for (f32 deltaTime = _timer.GetDeltaTime(); deltaTime < targetDelta - 0.0025f; deltaTime = _timer.GetDeltaTime())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        {
+            ZoneScopedNC("Yield", tracy::Color::AntiqueWhite1)
+            for (f32 deltaTime = _timer.GetDeltaTime(); deltaTime < targetDelta; deltaTime = _timer.GetDeltaTime())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    Timer _timer;
+};
+
+// Advances by exactly one tick every Tick and never waits, simulated runs are deterministic and as fast as the CPU allows
+class VirtualClock : public EngineClock
+{
+public:
+    VirtualClock(f32 tickDelta) : _tickDelta(tickDelta) { }
+
+    void Tick() override
+    {
+        _ticks++;
+    }
+    f32 GetDeltaTime() override { return _ticks ? _tickDelta : 0.0f; }
+    f64 GetLifeTime() override { return static_cast<f64>(_ticks) * _tickDelta; }
+    void WaitForTickRate(f32 targetDelta) override { }
+
+private:
+    f32 _tickDelta;
+    u64 _ticks = 0;
+};
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "PrefixTable.h"
+#include <Utils/DebugHandler.h>
+#include <fstream>
+#include <sstream>
+
+bool PrefixTable::Load(const std::string& path)
+{
+    std::ifstream stream(path);
+    if (!stream.is_open())
+        return false;
+
+    Clear();
+
+    std::string line;
+    u32 lineNumber = 0;
+    while (std::getline(stream, line))
+    {
+        lineNumber++;
+
+        std::istringstream lineStream(line);
+        std::string cidr;
+        std::string zoneName;
+        if (!(lineStream >> cidr) || cidr[0] == '#')
+            continue;
+
+        u32 octets[4] = { 0 };
+        u32 length = 0;
+        char dot[3] = { 0 };
+        char slash = 0;
+
+        std::istringstream cidrStream(cidr);
+        cidrStream >> octets[0] >> dot[0] >> octets[1] >> dot[1] >> octets[2] >> dot[2] >> octets[3] >> slash >> length;
+
+        bool isValid = !cidrStream.fail() && (lineStream >> zoneName) && slash == '/' && length <= 32;
+        for (u32 i = 0; i < 3; i++)
+            isValid &= dot[i] == '.';
+        for (u32 i = 0; i < 4; i++)
+            isValid &= octets[i] <= 255;
+
+        if (!isValid)
+        {
+            DebugHandler::PrintWarning("[PrefixTable]: Skipping invalid line %u in %s", lineNumber, path.c_str());
+            continue;
+        }
+
+        u32 prefix = (octets[0] << 24) | (octets[1] << 16) | (octets[2] << 8) | octets[3];
+        Add(prefix, static_cast<u8>(length), zoneName);
+    }
+
+    return true;
+}
+
+bool PrefixTable::Add(u32 prefix, u8 length, const std::string& zoneName)
+{
+    if (length > 32)
+        return false;
+
+    auto& prefixes = _prefixes[length];
+    auto result = prefixes.emplace(prefix & GetMask(length), GetOrCreateZone(zoneName));
+    if (!result.second)
+        return false;
+
+    _lengthMask |= 1ull << length;
+    _numPrefixes++;
+    return true;
+}
+
+void PrefixTable::Clear()
+{
+    for (auto& prefixes : _prefixes)
+        prefixes.clear();
+
+    _lengthMask = 0;
+    _numPrefixes = 0;
+    _zoneNames.clear();
+}
+
+u16 PrefixTable::Lookup(u32 address) const
+{
+    for (i32 length = 32; length >= 0; length--)
+    {
+        if (!(_lengthMask & (1ull << length)))
+            continue;
+
+        const auto& prefixes = _prefixes[length];
+        auto itr = prefixes.find(address & GetMask(static_cast<u8>(length)));
+        if (itr != prefixes.end())
+            return itr->second;
+    }
+
+    return INVALID_ZONE;
+}
+
+const std::string& PrefixTable::GetZoneName(u16 zone) const
+{
+    static const std::string unknown = "unknown";
+    return zone < _zoneNames.size() ? _zoneNames[zone] : unknown;
+}
+
+u16 PrefixTable::GetOrCreateZone(const std::string& zoneName)
+{
+    for (size_t i = 0; i < _zoneNames.size(); i++)
+    {
+        if (_zoneNames[i] == zoneName)
+            return static_cast<u16>(i);
+    }
+
+    _zoneNames.push_back(zoneName);
+    return static_cast<u16>(_zoneNames.size() - 1);
+}
@@ -0,0 +1,70 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <array>
+#include <string>
+#include <vector>
+
+/*
+    Maps IPv4 prefixes to zones with longest-prefix-match lookups.
+    Prefixes are kept in one hash map per prefix length, a lookup probes the lengths present from longest to shortest.
+*/
+class PrefixTable
+{
+public:
+    static constexpr u16 INVALID_ZONE = 0xFFFF;
+
+    // Each line is "<a.b.c.d>/<length> <zone>", empty lines and lines starting with # are skipped
+    bool Load(const std::string& path);
+    bool Add(u32 prefix, u8 length, const std::string& zoneName);
+    void Clear();
+
+    // Addresses are in host byte order
+    u16 Lookup(u32 address) const;
+    // Addresses as they are stored in ServerInformation and ConnectionInfo
+    u16 LookupNetworkOrder(u32 address) const { return Lookup(ToHostOrder(address)); }
+
+    const std::string& GetZoneName(u16 zone) const;
+    size_t GetNumPrefixes() const { return _numPrefixes; }
+    size_t GetNumZones() const { return _zoneNames.size(); }
+    bool IsEmpty() const { return _numPrefixes == 0; }
+
+    static u32 ToHostOrder(u32 networkOrder)
+    {
+        const u8* bytes = reinterpret_cast<const u8*>(&networkOrder);
+        return (static_cast<u32>(bytes[0]) << 24) | (static_cast<u32>(bytes[1]) << 16) | (static_cast<u32>(bytes[2]) << 8) | static_cast<u32>(bytes[3]);
+    }
+
+private:
+    static u32 GetMask(u8 length) { return length == 0 ? 0 : ~0u << (32 - length); }
+    u16 GetOrCreateZone(const std::string& zoneName);
+
+private:
+    std::array<robin_hood::unordered_map<u32, u16>, 33> _prefixes;
+    u64 _lengthMask = 0; // Bit n is set if any prefix of length n is present
+    size_t _numPrefixes = 0;
+
+    std::vector<std::string> _zoneNames;
+};
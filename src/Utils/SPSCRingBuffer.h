@@ -0,0 +1,120 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <array>
+#include <atomic>
+
+/*
+    Bounded single-producer/single-consumer ring.
+    Elements are either moved in and out, or used in place: the producer fills the slot TryReserve returns and publishes it with Commit,
+    the consumer works on the slot Front returns and hands it back with Pop. A slot is never reused before it is popped, so slots can own storage that outlives a single element.
+*/
+template <typename T, size_t Capacity>
+class SPSCRingBuffer
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SPSCRingBuffer Capacity must be a power of two");
+
+public:
+    bool TryEnqueue(T&& value)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cachedHead == Capacity)
+        {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            if (tail - _cachedHead == Capacity)
+                return false;
+        }
+
+        _slots[tail & MASK] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryDequeue(T& value)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _cachedTail)
+        {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head == _cachedTail)
+                return false;
+        }
+
+        value = std::move(_slots[head & MASK]);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    T* TryReserve()
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cachedHead == Capacity)
+        {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            if (tail - _cachedHead == Capacity)
+                return nullptr;
+        }
+
+        return &_slots[tail & MASK];
+    }
+    void Commit()
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    T* Front()
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _cachedTail)
+        {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head == _cachedTail)
+                return nullptr;
+        }
+
+        return &_slots[head & MASK];
+    }
+    void Pop()
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    size_t Size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+    bool IsFull() const { return Size() == Capacity; }
+    bool IsEmpty() const { return Size() == 0; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Producer and consumer indices live on separate cache lines, each side keeps a cached copy of the other's index to avoid bouncing it
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _head { 0 };
+    size_t _cachedTail = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _tail { 0 };
+    size_t _cachedHead = 0;
+
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> _slots;
+};
\ No newline at end of file
@@ -9,6 +9,13 @@ void ServiceLocator::SetRegistry(entt::registry* registry)
     assert(_gameRegistry == nullptr);
     _gameRegistry = registry;
 }
+entt::registry* ServiceLocator::ExchangeRegistry(entt::registry* registry)
+{
+    assert(registry != nullptr);
+    entt::registry* previous = _gameRegistry;
+    _gameRegistry = registry;
+    return previous;
+}
 void ServiceLocator::SetNetPacketHandler(NetPacketHandler* netPacketHandler)
 {
     assert(_netPacketHandler == nullptr);
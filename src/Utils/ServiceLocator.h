@@ -33,6 +33,8 @@ class ServiceLocator
 public:
     static entt::registry* GetRegistry() { return _gameRegistry; }
     static void SetRegistry(entt::registry* registry);
+    // Returns the previous registry, traffic replay points the handlers at its scratch registry while it dispatches
+    static entt::registry* ExchangeRegistry(entt::registry* registry);
     static NetPacketHandler* GetNetPacketHandler() { return _netPacketHandler; }
     static void SetNetPacketHandler(NetPacketHandler* serverMessageHandler);
 
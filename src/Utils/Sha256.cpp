@@ -0,0 +1,163 @@
+#include "Sha256.h"
+#include <cstring>
+
+static constexpr u32 ROUND_CONSTANTS[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline u32 RotateRight(u32 value, u32 count)
+{
+    return (value >> count) | (value << (32 - count));
+}
+
+void Sha256::Reset()
+{
+    _state = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    _bufferSize = 0;
+    _totalSize = 0;
+}
+
+void Sha256::Update(const void* data, size_t size)
+{
+    const u8* bytes = static_cast<const u8*>(data);
+    _totalSize += size;
+
+    if (_bufferSize > 0)
+    {
+        size_t toCopy = BLOCK_SIZE - _bufferSize;
+        if (toCopy > size)
+            toCopy = size;
+
+        std::memcpy(_buffer.data() + _bufferSize, bytes, toCopy);
+        _bufferSize += toCopy;
+        bytes += toCopy;
+        size -= toCopy;
+
+        if (_bufferSize < BLOCK_SIZE)
+            return;
+
+        Transform(_buffer.data());
+        _bufferSize = 0;
+    }
+
+    // Whole blocks are hashed straight from the input
+    while (size >= BLOCK_SIZE)
+    {
+        Transform(bytes);
+        bytes += BLOCK_SIZE;
+        size -= BLOCK_SIZE;
+    }
+
+    std::memcpy(_buffer.data(), bytes, size);
+    _bufferSize = size;
+}
+
+void Sha256::Final(u8* digest)
+{
+    u64 totalBits = _totalSize * 8;
+
+    // Padding is a single 1 bit, zeros up to 8 bytes short of a block and the message length in bits, big endian
+    u8 padding[BLOCK_SIZE * 2] = { 0x80 };
+    size_t paddingSize = (_bufferSize < BLOCK_SIZE - 8 ? BLOCK_SIZE : BLOCK_SIZE * 2) - _bufferSize;
+    for (size_t i = 0; i < 8; i++)
+    {
+        padding[paddingSize - 1 - i] = static_cast<u8>(totalBits >> (i * 8));
+    }
+
+    Update(padding, paddingSize);
+
+    for (size_t i = 0; i < _state.size(); i++)
+    {
+        digest[i * 4 + 0] = static_cast<u8>(_state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<u8>(_state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<u8>(_state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<u8>(_state[i]);
+    }
+
+    Reset();
+}
+
+void Sha256::Hash(const void* data, size_t size, u8* digest)
+{
+    Sha256 sha;
+    sha.Update(data, size);
+    sha.Final(digest);
+}
+
+void Sha256::Hmac(const u8* key, size_t keySize, const void* data, size_t size, u8* digest)
+{
+    // Keys longer than a block are hashed first, shorter ones are zero padded
+    u8 blockKey[BLOCK_SIZE] = {};
+    if (keySize > BLOCK_SIZE)
+        Hash(key, keySize, blockKey);
+    else
+        std::memcpy(blockKey, key, keySize);
+
+    u8 innerPad[BLOCK_SIZE];
+    u8 outerPad[BLOCK_SIZE];
+    for (size_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        innerPad[i] = blockKey[i] ^ 0x36;
+        outerPad[i] = blockKey[i] ^ 0x5c;
+    }
+
+    u8 innerDigest[DIGEST_SIZE];
+
+    Sha256 sha;
+    sha.Update(innerPad, BLOCK_SIZE);
+    sha.Update(data, size);
+    sha.Final(innerDigest);
+
+    sha.Update(outerPad, BLOCK_SIZE);
+    sha.Update(innerDigest, DIGEST_SIZE);
+    sha.Final(digest);
+}
+
+void Sha256::Transform(const u8* block)
+{
+    u32 schedule[64];
+    for (size_t i = 0; i < 16; i++)
+    {
+        schedule[i] = (static_cast<u32>(block[i * 4]) << 24) | (static_cast<u32>(block[i * 4 + 1]) << 16) | (static_cast<u32>(block[i * 4 + 2]) << 8) | static_cast<u32>(block[i * 4 + 3]);
+    }
+
+    for (size_t i = 16; i < 64; i++)
+    {
+        u32 s0 = RotateRight(schedule[i - 15], 7) ^ RotateRight(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+        u32 s1 = RotateRight(schedule[i - 2], 17) ^ RotateRight(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+        schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+    }
+
+    u32 a = _state[0], b = _state[1], c = _state[2], d = _state[3];
+    u32 e = _state[4], f = _state[5], g = _state[6], h = _state[7];
+
+    for (size_t i = 0; i < 64; i++)
+    {
+        u32 s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+        u32 choice = (e & f) ^ (~e & g);
+        u32 temp1 = h + s1 + choice + ROUND_CONSTANTS[i] + schedule[i];
+        u32 s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+        u32 majority = (a & b) ^ (a & c) ^ (b & c);
+        u32 temp2 = s0 + majority;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    _state[0] += a; _state[1] += b; _state[2] += c; _state[3] += d;
+    _state[4] += e; _state[5] += f; _state[6] += g; _state[7] += h;
+}
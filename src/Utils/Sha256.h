@@ -0,0 +1,57 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <array>
+
+/*
+    SHA-256 and HMAC-SHA256, used to authenticate datagrams with a key derived from the SRP session.
+    Datagrams are a few dozen bytes, so this favours a small state over throughput on large inputs.
+*/
+class Sha256
+{
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    using Digest = std::array<u8, DIGEST_SIZE>;
+
+    Sha256() { Reset(); }
+
+    void Reset();
+    void Update(const void* data, size_t size);
+    void Final(u8* digest);
+
+    static void Hash(const void* data, size_t size, u8* digest);
+    static void Hmac(const u8* key, size_t keySize, const void* data, size_t size, u8* digest);
+
+private:
+    void Transform(const u8* block);
+
+private:
+    std::array<u32, 8> _state;
+    std::array<u8, BLOCK_SIZE> _buffer;
+    size_t _bufferSize = 0;
+    u64 _totalSize = 0;
+};
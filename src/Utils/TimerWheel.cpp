@@ -0,0 +1,218 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel()
+{
+    std::fill(std::begin(_lists), std::end(_lists), INVALID_INDEX);
+}
+
+void TimerWheel::Reserve(u32 numTimers)
+{
+    _timers.reserve(numTimers);
+}
+
+TimerWheel::TimerHandle TimerWheel::Schedule(u64 delay, Callback callback, void* context, u64 data, u64 interval)
+{
+    u32 index = Allocate();
+    Timer& timer = _timers[index];
+    timer.expiresAt = _now + std::min(delay, MAX_DELAY);
+    timer.interval = interval;
+    timer.callback = callback;
+    timer.context = context;
+    timer.data = data;
+
+    Insert(index);
+    _numPending++;
+
+    return (static_cast<u64>(timer.generation) << 32) | index;
+}
+
+bool TimerWheel::Cancel(TimerHandle handle)
+{
+    u32 index = Resolve(handle);
+    if (index == INVALID_INDEX)
+        return false;
+
+    Unlink(index);
+    Free(index);
+    _numPending--;
+    return true;
+}
+
+bool TimerWheel::IsPending(TimerHandle handle) const
+{
+    return Resolve(handle) != INVALID_INDEX;
+}
+
+void TimerWheel::Advance(u64 now)
+{
+    if (now < _now)
+        return;
+
+    // Nothing can fire, skip the slots instead of walking them
+    if (_numPending == 0)
+    {
+        _now = now;
+        _currentTick = now + 1;
+        return;
+    }
+
+    for (; _currentTick <= now; _currentTick++)
+    {
+        u64 tick = _currentTick;
+
+        // Entering a new block of the level below, move the matching slot of each level down until one of them isn't wrapping too
+        if ((tick & SLOT_MASK) == 0)
+        {
+            for (u32 level = 1; level < NUM_LEVELS; level++)
+            {
+                u32 slot = static_cast<u32>(tick >> (SLOT_BITS * level)) & SLOT_MASK;
+                Cascade(level, slot);
+
+                if (slot != 0)
+                    break;
+            }
+        }
+
+        u32 list = static_cast<u32>(tick & SLOT_MASK);
+        if (_lists[list] == INVALID_INDEX)
+            continue;
+
+        // Timers scheduled by the callbacks are placed relative to the next tick, none of them can land in the list being fired
+        _lists[FIRING_LIST] = _lists[list];
+        _lists[list] = INVALID_INDEX;
+        for (u32 index = _lists[FIRING_LIST]; index != INVALID_INDEX; index = _timers[index].next)
+            _timers[index].list = FIRING_LIST;
+
+        _now = tick;
+        _currentTick = tick + 1;
+
+        while (_lists[FIRING_LIST] != INVALID_INDEX)
+        {
+            u32 index = _lists[FIRING_LIST];
+            Unlink(index);
+
+            // Copied out, the callback may schedule timers which grow the pool
+            Timer& timer = _timers[index];
+            Callback callback = timer.callback;
+            void* context = timer.context;
+            u64 data = timer.data;
+
+            if (timer.interval > 0)
+            {
+                // Re-armed before the callback runs so it can cancel its own periodic timer
+                timer.expiresAt = tick + timer.interval;
+                if (timer.expiresAt < _currentTick)
+                    timer.expiresAt = _currentTick;
+
+                Insert(index);
+            }
+            else
+            {
+                Free(index);
+                _numPending--;
+            }
+
+            callback(context, data, tick);
+        }
+
+        _currentTick = tick;
+    }
+
+    _now = now;
+}
+
+u32 TimerWheel::Allocate()
+{
+    if (_freeHead != INVALID_INDEX)
+    {
+        u32 index = _freeHead;
+        _freeHead = _timers[index].next;
+        _timers[index].next = INVALID_INDEX;
+        return index;
+    }
+
+    _timers.emplace_back();
+    return static_cast<u32>(_timers.size() - 1);
+}
+
+void TimerWheel::Free(u32 index)
+{
+    Timer& timer = _timers[index];
+    timer.list = INVALID_INDEX;
+    timer.callback = nullptr;
+    timer.generation++;
+    timer.prev = INVALID_INDEX;
+    timer.next = _freeHead;
+    _freeHead = index;
+}
+
+u32 TimerWheel::Resolve(TimerHandle handle) const
+{
+    u32 index = static_cast<u32>(handle);
+    u32 generation = static_cast<u32>(handle >> 32);
+    if (index >= _timers.size())
+        return INVALID_INDEX;
+
+    const Timer& timer = _timers[index];
+    if (timer.generation != generation || timer.list == INVALID_INDEX)
+        return INVALID_INDEX;
+
+    return index;
+}
+
+void TimerWheel::Insert(u32 index)
+{
+    const Timer& timer = _timers[index];
+    u64 expiresAt = std::max(timer.expiresAt, _currentTick);
+    u64 delay = expiresAt - _currentTick;
+
+    u32 level = 0;
+    while (level < NUM_LEVELS - 1 && delay >= (1ull << (SLOT_BITS * (level + 1))))
+        level++;
+
+    u32 slot = static_cast<u32>(expiresAt >> (SLOT_BITS * level)) & SLOT_MASK;
+    Link(index, level * NUM_SLOTS + slot);
+}
+
+void TimerWheel::Link(u32 index, u32 list)
+{
+    Timer& timer = _timers[index];
+    timer.list = list;
+    timer.prev = INVALID_INDEX;
+    timer.next = _lists[list];
+
+    if (timer.next != INVALID_INDEX)
+        _timers[timer.next].prev = index;
+
+    _lists[list] = index;
+}
+
+void TimerWheel::Unlink(u32 index)
+{
+    Timer& timer = _timers[index];
+    if (timer.prev != INVALID_INDEX)
+        _timers[timer.prev].next = timer.next;
+    else
+        _lists[timer.list] = timer.next;
+
+    if (timer.next != INVALID_INDEX)
+        _timers[timer.next].prev = timer.prev;
+
+    timer.prev = INVALID_INDEX;
+    timer.next = INVALID_INDEX;
+}
+
+void TimerWheel::Cascade(u32 level, u32 slot)
+{
+    u32 list = level * NUM_SLOTS + slot;
+    u32 index = _lists[list];
+    _lists[list] = INVALID_INDEX;
+
+    while (index != INVALID_INDEX)
+    {
+        u32 next = _timers[index].next;
+        Insert(index);
+        index = next;
+    }
+}
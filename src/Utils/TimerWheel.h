@@ -0,0 +1,99 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <vector>
+
+/*
+    Hierarchical timer wheel, scheduling and cancelling are O(1) and advancing costs one slot per elapsed tick plus the timers that fire or move down a level.
+    Four levels of 256 slots, a timer sits in the lowest level whose range covers its delay and is moved down as the wheel turns.
+    Timers live in one pool linked by index, hundreds of thousands of pending timers are a single allocation and callbacks are plain function pointers.
+*/
+class TimerWheel
+{
+public:
+    using TimerHandle = u64; // Generation in the high half, a handle to a timer that fired or was cancelled stays invalid even once its slot is reused
+    using Callback = void(*)(void* context, u64 data, u64 now); // now is the tick the timer fired on
+
+    static constexpr TimerHandle INVALID_HANDLE = 0;
+
+    // The wheel starts at tick 0, ticks are whatever unit the owner advances it in
+    TimerWheel();
+    void Reserve(u32 numTimers);
+
+    // Delays count from the tick last advanced to, or from the firing tick inside a callback. A delay of 0 fires on the next Advance, interval re-arms the timer every interval ticks until it is cancelled
+    TimerHandle Schedule(u64 delay, Callback callback, void* context, u64 data, u64 interval = 0);
+    bool Cancel(TimerHandle handle);
+    bool IsPending(TimerHandle handle) const;
+
+    // Fires every timer due at or before now, in order of their due tick. Callbacks may schedule and cancel timers
+    void Advance(u64 now);
+
+    u64 GetNow() const { return _now; }
+    u32 GetNumPending() const { return _numPending; }
+
+private:
+    static constexpr u32 SLOT_BITS = 8;
+    static constexpr u32 NUM_SLOTS = 1 << SLOT_BITS;
+    static constexpr u32 SLOT_MASK = NUM_SLOTS - 1;
+    static constexpr u32 NUM_LEVELS = 4;
+    static constexpr u64 MAX_DELAY = (1ull << (SLOT_BITS * NUM_LEVELS)) - 1;
+
+    static constexpr u32 INVALID_INDEX = ~0u;
+    static constexpr u32 FIRING_LIST = NUM_SLOTS * NUM_LEVELS; // Holds the timers of the slot being fired, so cancelling one of them still unlinks it
+
+    struct Timer
+    {
+        u64 expiresAt = 0;
+        u64 interval = 0;
+        Callback callback = nullptr;
+        void* context = nullptr;
+        u64 data = 0;
+
+        u32 prev = INVALID_INDEX;
+        u32 next = INVALID_INDEX; // Also links the free list
+        u32 list = INVALID_INDEX; // INVALID_INDEX while the timer is free
+        u32 generation = 1;
+    };
+
+    u32 Allocate();
+    void Free(u32 index);
+    u32 Resolve(TimerHandle handle) const;
+
+    void Insert(u32 index);
+    void Link(u32 index, u32 list);
+    void Unlink(u32 index);
+
+    void Cascade(u32 level, u32 slot);
+
+private:
+    std::vector<Timer> _timers;
+    u32 _freeHead = INVALID_INDEX;
+    u32 _numPending = 0;
+
+    u32 _lists[NUM_SLOTS * NUM_LEVELS + 1];
+
+    u64 _now = 0;
+    u64 _currentTick = 0; // The next tick Advance processes
+};
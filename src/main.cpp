@@ -4,25 +4,144 @@
 #include <Utils/StringUtils.h>
 
 #include <future>
+#include <thread>
+#include <cstdlib>
 
 #include "EngineLoop.h"
+#include "Utils/AsyncLogger.h"
 #include "ConsoleCommands.h"
 
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 
-i32 main()
+// Takes [address:]port, the address is left untouched if there is none
+static bool ParseEndpoint(std::string endpoint, std::string& address, u16& port)
+{
+    size_t separator = endpoint.rfind(':');
+    if (separator != std::string::npos)
+    {
+        address = endpoint.substr(0, separator);
+        endpoint = endpoint.substr(separator + 1);
+    }
+
+    i32 value = std::atoi(endpoint.c_str());
+    if (value <= 0 || value > 65535)
+    {
+        DebugHandler::PrintError("Invalid port: %s", endpoint.c_str());
+        return false;
+    }
+
+    port = static_cast<u16>(value);
+    return true;
+}
+
+// --network <socket|io_uring|posix> selects the network backend, posix unless on Windows
+// --handoff <path> takes the upstream connection over from a running load balancer listening on the Unix socket, then listens on it for the next hot restart
+// --listen <[address:]port> accepts address requests from direct clients, on 127.0.0.1 unless an address is given
+// --udp <[address:]port> accepts signed datagram address requests, on 127.0.0.1 unless an address is given
+// --zones <file> loads a prefix to zone table and enables the proximity policy
+// --slow-start <seconds> sets how long a server added while running takes to ramp up to its full share, 0 disables slow start
+// --simulate <seconds> [--seed <seed>] runs against a simulated upstream on a virtual clock and exits with a report
+static bool ParseArguments(i32 argc, char* argv[], EngineSettings& settings)
+{
+    SimulationSettings& simulationSettings = settings.simulation;
+
+    for (i32 i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--network" && hasValue)
+        {
+            std::string backend = argv[++i];
+            if (backend == "io_uring")
+            {
+                settings.networkBackend = NetworkBackend::IO_URING;
+            }
+            else if (backend == "socket")
+            {
+                settings.networkBackend = NetworkBackend::SOCKET;
+            }
+            else if (backend == "posix")
+            {
+                settings.networkBackend = NetworkBackend::POSIX;
+            }
+            else
+            {
+                DebugHandler::PrintError("Unknown network backend: %s", backend.c_str());
+                return false;
+            }
+        }
+        else if (argument == "--handoff" && hasValue)
+        {
+            settings.handoffPath = argv[++i];
+        }
+        else if (argument == "--listen" && hasValue)
+        {
+            if (!ParseEndpoint(argv[++i], settings.listenAddress, settings.listenPort))
+                return false;
+        }
+        else if (argument == "--udp" && hasValue)
+        {
+            if (!ParseEndpoint(argv[++i], settings.datagramAddress, settings.datagramPort))
+                return false;
+        }
+        else if (argument == "--zones" && hasValue)
+        {
+            settings.zoneFile = argv[++i];
+        }
+        else if (argument == "--slow-start" && hasValue)
+        {
+            std::string window = argv[++i];
+            char* end = nullptr;
+            settings.slowStartWindow = std::strtof(window.c_str(), &end);
+            if (end == window.c_str() || *end != '\0' || settings.slowStartWindow < 0.0f)
+            {
+                DebugHandler::PrintError("Invalid slow start window: %s", window.c_str());
+                return false;
+            }
+        }
+        else if (argument == "--simulate" && hasValue)
+        {
+            simulationSettings.enabled = true;
+            simulationSettings.duration = std::strtod(argv[++i], nullptr);
+        }
+        else if (argument == "--seed" && hasValue)
+        {
+            simulationSettings.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            DebugHandler::PrintError("Unknown argument: %s", argument.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+i32 main(i32 argc, char* argv[])
 {
 #ifdef _WIN32 //Windows
     SetConsoleTitle(WINDOWNAME);
 #endif
 
-    EngineLoop engineLoop;
+    EngineSettings settings;
+    if (!ParseArguments(argc, argv, settings))
+        return 1;
+
+    AsyncLogger::Start();
+
+    EngineLoop engineLoop(settings);
     engineLoop.Start();
 
     ConsoleCommandHandler consoleCommandHandler;
-    std::future<std::string> future = std::async(std::launch::async, StringUtils::GetLineFromCin);
+    // Simulations run unattended, we don't read the console so we can exit as soon as the report is printed
+    std::future<std::string> future;
+    if (!settings.simulation.enabled)
+        future = std::async(std::launch::async, StringUtils::GetLineFromCin);
+
     while (true)
     {
         Message message;
@@ -45,16 +164,19 @@ i32 main()
         if (shouldExit)
             break;
 
-        if (future.wait_for(std::chrono::milliseconds(50)) == std::future_status::ready)
+        if (!future.valid())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        else if (future.wait_for(std::chrono::milliseconds(50)) == std::future_status::ready)
         {
             std::string command = future.get();
-            std::transform(command.begin(), command.end(), command.begin(), ::tolower); // Convert command to lowercase
-
             consoleCommandHandler.HandleCommand(engineLoop, command);
             future = std::async(std::launch::async, StringUtils::GetLineFromCin);
         }
     }
 
     engineLoop.Stop();
+    AsyncLogger::Stop();
     return 0;
 }
\ No newline at end of file